@@ -3,6 +3,7 @@
  */
 #include <string.h>
 #include <ctype.h>
+#define MEMTAG memClexer
 #include "gen.h"
 #include "types.h"
 #include "error.h"
@@ -32,6 +33,8 @@ struct clexer {
     int         charquote;      /* count of characters inside single quotes */
     int         parenlevel;     /* nesting level of parentheses */
     int         charcount;      /* actual size of current character token */
+    int         quiet;          /* true if errors are counted, not reported */
+    int         errorcount;     /* number of errors found while quiet */
 };
 
 /* The list of preprocess statements that the program knows about,
@@ -71,6 +74,8 @@ clexer *initclexer(void)
     cl->charquote = 0;
     cl->parenlevel = 0;
     cl->charcount = 0;
+    cl->quiet = FALSE;
+    cl->errorcount = 0;
     return cl;
 }
 
@@ -89,6 +94,75 @@ void allowmultichars(int flag)
     multicharsallowed = flag;
 }
 
+/* Returns the current setting for multi-char literals.
+ */
+int multicharsallowedp(void)
+{
+    return multicharsallowed;
+}
+
+/* Enable and disable quiet mode, in which errors are only counted.
+ */
+void quietclexer(clexer *cl, int flag)
+{
+    cl->quiet = flag;
+    cl->errorcount = 0;
+}
+
+/* Returns the number of errors found in quiet mode.
+ */
+int getlexererrors(clexer const *cl)
+{
+    return cl->errorcount;
+}
+
+/* Reports an error found in the input, or just counts it if the lexer
+ * is in quiet mode.
+ */
+static void lexerror(clexer *cl, enum errortype type)
+{
+    if (cl->quiet)
+        ++cl->errorcount;
+    else
+        error(type);
+}
+
+/* Copies out the part of the lexer's state that carries over from one
+ * line to the next.
+ */
+void savelexerstate(clexer const *cl, clexerstate *saved)
+{
+    saved->state = cl->state;
+    saved->charquote = cl->charquote;
+}
+
+/* Restores a previously saved state. The parenthesis level is left
+ * as is.
+ */
+void restorelexerstate(clexer *cl, clexerstate const *saved)
+{
+    cl->state = saved->state;
+    cl->charquote = saved->charquote;
+    cl->charcount = 0;
+}
+
+/* Sets the lexer's state to the beginning of a line, either inside or
+ * outside of a multi-line comment.
+ */
+void presumelexerstate(clexer *cl, int incomment)
+{
+    cl->state = incomment ? F_InComment : 0;
+    cl->charquote = 0;
+    cl->charcount = 0;
+}
+
+/* Returns true if the two saved states are the same.
+ */
+int samelexerstate(clexerstate const *a, clexerstate const *b)
+{
+    return a->state == b->state && a->charquote == b->charquote;
+}
+
 /* Boolean functions that report on various aspects of the lexer's
  * current state.
  */
@@ -134,7 +208,7 @@ static char const *readwhack(clexer *cl, char const *input)
             if (!isxdigit(input[n]))
                 break;
         if (n == 1)
-            error(errBadCharLiteral);
+            lexerror(cl, errBadCharLiteral);
         input += n - 1;
         cl->charcount += n - 1;
     } else {
@@ -148,7 +222,7 @@ static char const *readwhack(clexer *cl, char const *input)
           case 'v':
             break;
           default:
-            error(errBadCharLiteral);
+            lexerror(cl, errBadCharLiteral);
             break;
         }
     }
@@ -206,10 +280,10 @@ static char const *examinechar(clexer *cl, char const *input)
             ++cl->charquote;
         } else if (*in == '\'') {
             if (!cl->charquote) {
-                error(errBadCharLiteral);
+                lexerror(cl, errBadCharLiteral);
             } else if (!multicharsallowed) {
                 if (cl->charquote > (cl->state & F_LongChar ? 4 : 1))
-                    error(errBadCharLiteral);
+                    lexerror(cl, errBadCharLiteral);
             }
             cl->state |= F_LeavingCharQuote;
             cl->state &= ~F_LongChar;
@@ -360,6 +434,13 @@ void endstream(clexer *cl)
         error(errOpenStringLiteral);
     else if (cl->state & F_InComment)
         error(errOpenComment);
+    abandonstream(cl);
+}
+
+/* Re-initializes the lexer without checking for errors.
+ */
+void abandonstream(clexer *cl)
+{
     cl->state = 0;
     cl->charquote = 0;
     cl->parenlevel = 0;
@@ -27,6 +27,15 @@ enum ppcmd
     cmdOther
 };
 
+/* The part of the lexer's state that carries over from the end of one
+ * line to the start of the next. The parenthesis nesting level is not
+ * included, since only changes in it within a line are meaningful.
+ */
+typedef struct clexerstate {
+    int         state;          /* the lexer's state flags */
+    int         charquote;      /* count of characters inside single quotes */
+} clexerstate;
+
 /* Returns the length of the C identifier located at input, or zero if
  * input does not point to a valid C identifier.
  */
@@ -46,6 +55,33 @@ extern void freeclexer(clexer *cl);
  */
 extern void allowmultichars(int flag);
 
+/* Returns true if multiple-character literals are allowed.
+ */
+extern int multicharsallowedp(void);
+
+/* Enable and disable quiet mode. In quiet mode, errors in the input
+ * are counted instead of being reported. Enabling quiet mode resets
+ * the count to zero.
+ */
+extern void quietclexer(clexer *cl, int flag);
+
+/* Returns the number of errors found since quiet mode was enabled.
+ */
+extern int getlexererrors(clexer const *cl);
+
+/* Save and restore the lexer's state between lines, and compare two
+ * saved states. These allow a lexer to resume at a line that was
+ * examined earlier, possibly by a different lexer.
+ */
+extern void savelexerstate(clexer const *cl, clexerstate *saved);
+extern void restorelexerstate(clexer *cl, clexerstate const *saved);
+extern int samelexerstate(clexerstate const *a, clexerstate const *b);
+
+/* Sets the lexer's state to that of the beginning of a line, either
+ * inside or outside of a multi-line comment.
+ */
+extern void presumelexerstate(clexer *cl, int incomment);
+
 /* These functions all return true or false depending on what the
  * lexer has last examined.
  */
@@ -111,4 +147,10 @@ extern void endline(clexer *cl);
  */
 extern void endstream(clexer *cl);
 
+/* Stop examining the current input file before reaching its end.
+ * Unlike endstream(), no errors are reported for unclosed quotes or
+ * comments.
+ */
+extern void abandonstream(clexer *cl);
+
 #endif
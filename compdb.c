@@ -0,0 +1,456 @@
+/* compdb.c: Copyright (C) 2022 by Brian Raiter <breadbox@muppetlabs.com>
+ * License GPLv2+: GNU GPL version 2 or later.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#define MEMTAG memCompdb
+#include "gen.h"
+#include "types.h"
+#include "compdb.h"
+
+/* One entry of the database.
+ */
+typedef struct compentry {
+    char       *file;           /* the source file's full pathname */
+    char      **args;           /* the compiler's arguments */
+} compentry;
+
+/* The compilation database.
+ */
+struct compdb {
+    compentry  *entries;        /* the list of entries */
+    int         count;          /* the number of entries */
+    int         allocated;      /* the size of the entries array */
+};
+
+/* The state of the JSON parser.
+ */
+typedef struct jsonparser {
+    char const *p;              /* the current position in the text */
+    char const *end;            /* the end of the text */
+} jsonparser;
+
+/* Advances past any whitespace. The return value is the next
+ * character, or EOF at the end of the text.
+ */
+static int skipspace(jsonparser *jp)
+{
+    while (jp->p < jp->end && isspace((unsigned char)*jp->p))
+        ++jp->p;
+    return jp->p < jp->end ? (unsigned char)*jp->p : EOF;
+}
+
+/* Advances past the given punctuation character, if it is next. The
+ * return value is false if it is not.
+ */
+static int expect(jsonparser *jp, int ch)
+{
+    if (skipspace(jp) != ch)
+        return FALSE;
+    ++jp->p;
+    return TRUE;
+}
+
+/* Reads the four hex digits of a \u escape sequence at *pp, which
+ * must come before end. The return value is -1 if they are not valid.
+ */
+static long gethexcode(char const **pp, char const *end)
+{
+    long value;
+    int i, ch;
+
+    if (end - *pp < 4)
+        return -1;
+    value = 0;
+    for (i = 0 ; i < 4 ; ++i) {
+        ch = (unsigned char)*(*pp)++;
+        if (!isxdigit(ch))
+            return -1;
+        value = value * 16 + (isdigit(ch) ? ch - '0'
+                                          : tolower(ch) - 'a' + 10);
+    }
+    return value;
+}
+
+/* Stores a character code as UTF-8. The return value is the number of
+ * bytes stored.
+ */
+static int pututf8(char *out, long code)
+{
+    if (code < 0x80) {
+        out[0] = (char)code;
+        return 1;
+    } else if (code < 0x800) {
+        out[0] = (char)(0xC0 | (code >> 6));
+        out[1] = (char)(0x80 | (code & 0x3F));
+        return 2;
+    } else if (code < 0x10000) {
+        out[0] = (char)(0xE0 | (code >> 12));
+        out[1] = (char)(0x80 | ((code >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (code & 0x3F));
+        return 3;
+    }
+    out[0] = (char)(0xF0 | (code >> 18));
+    out[1] = (char)(0x80 | ((code >> 12) & 0x3F));
+    out[2] = (char)(0x80 | ((code >> 6) & 0x3F));
+    out[3] = (char)(0x80 | (code & 0x3F));
+    return 4;
+}
+
+/* Decodes the escape sequences in the body of a string, which lies
+ * between p and end. The return value is the allocated string, or NULL
+ * if an escape sequence is invalid.
+ */
+static char *decodestring(char const *p, char const *end)
+{
+    char *str;
+    long code, low;
+    int n, ch;
+
+    str = allocate(end - p + 1);
+    n = 0;
+    while (p < end) {
+        ch = *p++;
+        if (ch != '\\') {
+            str[n++] = ch;
+            continue;
+        }
+        ch = *p++;
+        switch (ch) {
+          case 'b':     str[n++] = '\b';        break;
+          case 'f':     str[n++] = '\f';        break;
+          case 'n':     str[n++] = '\n';        break;
+          case 'r':     str[n++] = '\r';        break;
+          case 't':     str[n++] = '\t';        break;
+          case 'u':
+            code = gethexcode(&p, end);
+            if (code >= 0xD800 && code < 0xDC00 && end - p >= 6
+                               && p[0] == '\\' && p[1] == 'u') {
+                p += 2;
+                low = gethexcode(&p, end);
+                if (low >= 0xDC00 && low < 0xE000)
+                    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                else
+                    code = -1;
+            }
+            if (code <= 0) {
+                deallocate(str);
+                return NULL;
+            }
+            n += pututf8(str + n, code);
+            break;
+          default:      str[n++] = ch;          break;
+        }
+    }
+    str[n] = '\0';
+    return str;
+}
+
+/* Reads a string value. If pstr is not NULL, it receives the decoded
+ * string, which is allocated. The return value is false if the string
+ * is malformed.
+ */
+static int getstring(jsonparser *jp, char **pstr)
+{
+    char const *start;
+
+    if (!expect(jp, '"'))
+        return FALSE;
+    start = jp->p;
+    while (jp->p < jp->end && *jp->p != '"')
+        jp->p += *jp->p == '\\' && jp->p + 1 < jp->end ? 2 : 1;
+    if (jp->p >= jp->end)
+        return FALSE;
+    if (pstr && !(*pstr = decodestring(start, jp->p)))
+        return FALSE;
+    ++jp->p;
+    return TRUE;
+}
+
+/* Advances past a value of any kind without examining it. Nested
+ * arrays and objects are tracked with a count rather than recursion.
+ * The return value is false if the value is malformed.
+ */
+static int skipvalue(jsonparser *jp)
+{
+    int depth, ch;
+
+    depth = 0;
+    do {
+        ch = skipspace(jp);
+        if (ch == EOF) {
+            return FALSE;
+        } else if (ch == '"') {
+            if (!getstring(jp, NULL))
+                return FALSE;
+        } else if (ch == '[' || ch == '{') {
+            ++depth;
+            ++jp->p;
+        } else if (ch == ']' || ch == '}' || ch == ',' || ch == ':') {
+            if (!depth)
+                return FALSE;
+            if (ch == ']' || ch == '}')
+                --depth;
+            ++jp->p;
+        } else {
+            if (!isalnum(ch) && ch != '-')
+                return FALSE;
+            while (jp->p < jp->end && (isalnum((unsigned char)*jp->p)
+                                       || strchr("+-.", *jp->p)))
+                ++jp->p;
+        }
+    } while (depth);
+    return TRUE;
+}
+
+/* Appends an argument to an allocated, NULL-terminated array.
+ */
+static char **addarg(char **args, int *count, char *arg)
+{
+    args = reallocate(args, (*count + 2) * sizeof *args);
+    args[(*count)++] = arg;
+    args[*count] = NULL;
+    return args;
+}
+
+/* Deallocates an array of arguments.
+ */
+static void freeargs(char **args)
+{
+    int i;
+
+    if (args) {
+        for (i = 0 ; args[i] ; ++i)
+            deallocate(args[i]);
+        deallocate(args);
+    }
+}
+
+/* Reads an array of strings. The return value is false if the array
+ * is malformed.
+ */
+static int parsestringarray(jsonparser *jp, char ***pargs)
+{
+    char **args;
+    char *arg;
+    int count;
+
+    if (!expect(jp, '['))
+        return FALSE;
+    args = allocate(sizeof *args);
+    args[0] = NULL;
+    count = 0;
+    if (!expect(jp, ']')) {
+        do {
+            if (!getstring(jp, &arg)) {
+                freeargs(args);
+                return FALSE;
+            }
+            args = addarg(args, &count, arg);
+        } while (expect(jp, ','));
+        if (!expect(jp, ']')) {
+            freeargs(args);
+            return FALSE;
+        }
+    }
+    *pargs = args;
+    return TRUE;
+}
+
+/* Splits a command line into arguments, applying the quoting rules of
+ * a POSIX shell: single quotes preserve everything, double quotes
+ * preserve everything but certain escaped characters, and an unquoted
+ * backslash preserves the character after it.
+ */
+static char **splitcommand(char const *cmd)
+{
+    char **args;
+    char *buf, *arg;
+    int count, n;
+
+    args = allocate(sizeof *args);
+    args[0] = NULL;
+    count = 0;
+    buf = allocate(strlen(cmd) + 1);
+    for (;;) {
+        while (isspace((unsigned char)*cmd))
+            ++cmd;
+        if (!*cmd)
+            break;
+        n = 0;
+        while (*cmd && !isspace((unsigned char)*cmd)) {
+            if (*cmd == '\'') {
+                for (++cmd ; *cmd && *cmd != '\'' ; ++cmd)
+                    buf[n++] = *cmd;
+                if (*cmd)
+                    ++cmd;
+            } else if (*cmd == '"') {
+                for (++cmd ; *cmd && *cmd != '"' ; ++cmd) {
+                    if (*cmd == '\\' && cmd[1] && strchr("\"\\$`", cmd[1]))
+                        ++cmd;
+                    buf[n++] = *cmd;
+                }
+                if (*cmd)
+                    ++cmd;
+            } else {
+                if (*cmd == '\\' && cmd[1])
+                    ++cmd;
+                buf[n++] = *cmd++;
+            }
+        }
+        arg = allocate(n + 1);
+        memcpy(arg, buf, n);
+        arg[n] = '\0';
+        args = addarg(args, &count, arg);
+    }
+    deallocate(buf);
+    return args;
+}
+
+/* Reads one object from the database's array. The entry receives the
+ * source file's pathname and the compiler's arguments. The return
+ * value is false if the object is malformed or incomplete.
+ */
+static int parseentry(jsonparser *jp, compentry *entry)
+{
+    char *key, *dir, *file, *cmd;
+    char **args;
+    int ok;
+
+    if (!expect(jp, '{'))
+        return FALSE;
+    dir = file = cmd = NULL;
+    args = NULL;
+    ok = TRUE;
+    if (!expect(jp, '}')) {
+        do {
+            if (!(ok = getstring(jp, &key)))
+                break;
+            ok = expect(jp, ':');
+            if (ok && !strcmp(key, "directory") && !dir)
+                ok = getstring(jp, &dir);
+            else if (ok && !strcmp(key, "file") && !file)
+                ok = getstring(jp, &file);
+            else if (ok && !strcmp(key, "command") && !cmd)
+                ok = getstring(jp, &cmd);
+            else if (ok && !strcmp(key, "arguments") && !args)
+                ok = parsestringarray(jp, &args);
+            else if (ok)
+                ok = skipvalue(jp);
+            deallocate(key);
+        } while (ok && expect(jp, ','));
+        ok = ok && expect(jp, '}');
+    }
+    if (ok && file && (args || cmd)) {
+        if (!args)
+            args = splitcommand(cmd);
+        if (file[0] == '/' || !dir) {
+            entry->file = file;
+        } else {
+            entry->file = allocate(strlen(dir) + strlen(file) + 2);
+            sprintf(entry->file, "%s/%s", dir, file);
+            deallocate(file);
+        }
+        entry->args = args;
+    } else {
+        ok = FALSE;
+        deallocate(file);
+        freeargs(args);
+    }
+    deallocate(dir);
+    deallocate(cmd);
+    return ok;
+}
+
+/* Reads the entire file into memory, and parses the array of entries.
+ */
+compdb *readcompdb(FILE *fp)
+{
+    compdb *db;
+    jsonparser jp;
+    char *buf;
+    size_t size, allocated;
+    int ok;
+
+    allocated = 65536;
+    buf = allocate(allocated);
+    size = 0;
+    for (;;) {
+        size += fread(buf + size, 1, allocated - size, fp);
+        if (size < allocated)
+            break;
+        allocated *= 2;
+        buf = reallocate(buf, allocated);
+    }
+    if (ferror(fp)) {
+        deallocate(buf);
+        return NULL;
+    }
+
+    db = allocate(sizeof *db);
+    db->entries = NULL;
+    db->count = 0;
+    db->allocated = 0;
+    jp.p = buf;
+    jp.end = buf + size;
+    ok = expect(&jp, '[');
+    if (ok && !expect(&jp, ']')) {
+        do {
+            if (db->count == db->allocated) {
+                db->allocated = db->allocated ? 2 * db->allocated : 64;
+                db->entries = reallocate(db->entries,
+                                         db->allocated * sizeof *db->entries);
+            }
+            if (!(ok = parseentry(&jp, &db->entries[db->count])))
+                break;
+            ++db->count;
+        } while (expect(&jp, ','));
+        ok = ok && expect(&jp, ']');
+    }
+    ok = ok && skipspace(&jp) == EOF;
+    deallocate(buf);
+    if (!ok) {
+        freecompdb(db);
+        errno = 0;
+        return NULL;
+    }
+    return db;
+}
+
+/* Deallocates the database.
+ */
+void freecompdb(compdb *db)
+{
+    int i;
+
+    for (i = 0 ; i < db->count ; ++i) {
+        deallocate(db->entries[i].file);
+        freeargs(db->entries[i].args);
+    }
+    deallocate(db->entries);
+    deallocate(db);
+}
+
+/* Returns the number of entries.
+ */
+int getcompdbcount(compdb const *db)
+{
+    return db->count;
+}
+
+/* Returns an entry's source file.
+ */
+char const *getcompdbfile(compdb const *db, int n)
+{
+    return db->entries[n].file;
+}
+
+/* Returns an entry's arguments.
+ */
+char **getcompdbargs(compdb const *db, int n)
+{
+    return db->entries[n].args;
+}
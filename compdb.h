@@ -0,0 +1,42 @@
+/* compdb.h: Copyright (C) 2022 by Brian Raiter <breadbox@muppetlabs.com>
+ * License GPLv2+: GNU GPL version 2 or later.
+ */
+#ifndef _compdb_h_
+#define _compdb_h_
+
+/*
+ * A compdb object holds the contents of a compilation database, the
+ * compile_commands.json file produced by many build systems. Each
+ * entry gives a source file, the directory it is compiled in, and the
+ * command line that compiles it. A command given as a single string
+ * is split into arguments the way a POSIX shell would.
+ */
+
+#include <stdio.h>
+#include "types.h"
+
+/* Reads a compilation database from fp. The return value is NULL if
+ * the file could not be read, in which case errno is set, or if it is
+ * not a valid compilation database, in which case errno is zero.
+ */
+extern compdb *readcompdb(FILE *fp);
+
+/* Deallocates the compilation database.
+ */
+extern void freecompdb(compdb *db);
+
+/* Returns the number of entries in the database.
+ */
+extern int getcompdbcount(compdb const *db);
+
+/* Returns the pathname of the source file for an entry. A relative
+ * filename is joined to the entry's directory.
+ */
+extern char const *getcompdbfile(compdb const *db, int n);
+
+/* Returns the compiler arguments for an entry, as an array that is
+ * terminated by a NULL. The first element is the compiler itself.
+ */
+extern char **getcompdbargs(compdb const *db, int n);
+
+#endif
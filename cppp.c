@@ -7,13 +7,25 @@
 #include <limits.h>
 #include <errno.h>
 #include <stdarg.h>
+#include <ctype.h>
 #include "gen.h"
 #include "types.h"
 #include "unixisms.h"
 #include "error.h"
 #include "symset.h"
 #include "ppproc.h"
+#include "deps.h"
 #include "clexer.h"
+#include "server.h"
+#include "watch.h"
+#include "tar.h"
+#include "compdb.h"
+#include "journal.h"
+#include "perfctr.h"
+
+/* The suffix appended to a source file's name to name its index file.
+ */
+#define INDEX_SUFFIX ".cppp-index"
 
 /* Online help text.
  */
@@ -24,14 +36,62 @@ static char const *const yowzitch1 =
 static char const *const yowzitch2 =
     "      -D SYMBOL[=NUMBER]  Preprocess SYMBOL as defined [to NUMBER].\n"
     "      -U SYMBOL           Preprocess SYMBOL as undefined.\n"
+    "                          SYMBOL can contain the wildcards * and ?.\n"
     "      -t, --trigraphs     Enable trigraph handling.\n"
     "      -c, --multichar     Don't warn on multiple-character literals.\n"
+    "      -j, --jobs N        Use N threads to process large files.\n"
+    "      --emit-edits        Output a unified diff of the changes.\n"
+    "      --check             Exit with status 1 if any file would change.\n"
+    "      --list-affected     List the files that would change.\n"
+    "      --build-index       Write an index of each SOURCE's directives.\n"
+    "      --apply-index       Use the SOURCE files' indexes when present.\n"
+    "      --deps              List the symbols tested by each SOURCE file,\n"
+    "                          and the files that test each symbol.\n"
+    "      --variants SYM,...  Report which combinations of the SYMs give\n"
+    "                          distinct output for SOURCE.\n"
+    "      --compile-db FILE   Process each file in the compilation database\n"
+    "                          FILE with the -D and -U flags it is compiled\n"
+    "                          with, in addition to the ones given here.\n"
+    "      --tar-in, --tar-out Read a tar archive and write it with each C\n"
+    "                          and C++ source file processed.\n"
+    "      --stats             Report memory usage on standard error.\n"
+    "      --perf-counters     Report hardware event counts per byte of\n"
+    "                          input for each phase on standard error.\n"
+    "      --files-from FILE   Read SOURCE filenames from FILE, one per\n"
+    "                          line or NUL-terminated (- for stdin).\n"
+    "      --shard I/N         Only process the SOURCE files in shard I of\n"
+    "                          N (numbered from 0), as selected by a hash\n"
+    "                          of each filename.\n"
+    "      --dedup HOW         Process identical SOURCE files only once, and\n"
+    "                          output the duplicates as a copy, link, or\n"
+    "                          reflink of the first.\n"
+    "      --journal FILE      Record each completed file in FILE, and skip\n"
+    "                          the files it shows are already done.\n"
+    "      --emit-specialized FILE\n"
+    "                          Write to FILE the source of a program that\n"
+    "                          preprocesses with these symbols built in.\n"
+    "      --server SOCKET     Serve requests sent to SOCKET by --client.\n"
+    "      --client SOCKET     Send the remaining arguments to a server.\n"
+    "      --watch             Process the SOURCE directory tree to DEST,\n"
+    "                          and keep reprocessing files as they change.\n"
     "      --help              Display this help and exit.\n"
     "      --version           Display version information and exit.\n\n";
 static char const *const yowzitch3 =
     "If DEST is omitted, the resulting source is emitted to standard output.\n"
     "If multiple SOURCE files are specified, the last argument DEST must be\n"
-    "a directory.\n";
+    "a directory. With --emit-edits, all arguments are SOURCE files, and\n"
+    "the changes to each are written together to standard output. The same\n"
+    "is true of --check and --list-affected, which produce no other output,\n"
+    "and of --build-index, which writes each index to SOURCE" INDEX_SUFFIX ".\n"
+    "With --deps, SOURCE can also be a directory, which is searched\n"
+    "recursively for C and C++ source files. With --variants, a single\n"
+    "SOURCE is analyzed, and if DEST is given, it must be a directory, to\n"
+    "which one output for each distinct variant N is written as N-SOURCE.\n"
+    "With --files-from or --shard, DEST must be a directory, and each\n"
+    "output is written to the SOURCE's relative pathname within DEST.\n"
+    "With --tar-in and --tar-out, SOURCE and DEST are archive files.\n"
+    "With --compile-db, only DEST is given, as with --files-from.\n"
+    "--journal applies whenever each output is written to its own file.\n";
 
 /* Version identifier.
  */
@@ -42,6 +102,48 @@ static char const *const vourzhon =
     "This is free software; you are free to change and redistribute it.\n"
     "There is no warranty, to the extent permitted by law.\n";
 
+/* The ways of outputting a file whose contents duplicate those of an
+ * earlier file.
+ */
+enum { dedupOff = 0, dedupCopy, dedupLink, dedupReflink };
+
+/* Settings selected on the command line that determine how the files
+ * are processed, beyond the symbols themselves.
+ */
+static struct {
+    int         edits;          /* output an edit script instead of files */
+    int         check;          /* only determine if files would change */
+    int         listaffected;   /* list the files that would change */
+    int         buildindex;     /* write index files instead of output */
+    int         applyindex;     /* use the index files when present */
+    int         deps;           /* output the symbols each file tests */
+    char      **variants;       /* the symbols to analyze variants of */
+    int         variantcount;   /* the number of symbols to analyze */
+    int         stats;          /* report memory usage when done */
+    int         perfcounters;   /* report hardware event counts when done */
+    char const *filesfrom;      /* the file listing the SOURCE files */
+    int         shard;          /* which shard of the files to process */
+    int         shardcount;     /* the number of shards, or zero */
+    int         dedup;          /* how to output duplicate inputs */
+    char const *journal;        /* the journal of completed files */
+    char const *specialized;    /* the file to write a program to */
+    int         tarin;          /* read SOURCE as a tar archive */
+    int         tarout;         /* write the output as a tar archive */
+    char const *compiledb;      /* the compilation database to follow */
+    int         jobs;           /* the number of jobs to run at once */
+    char const *server;         /* the socket to listen on as a server */
+    int         watch;          /* keep processing files as they change */
+    int         request;        /* true if running a server request */
+} settings;
+
+/* The symbol configuration loaded when the program starts.
+ */
+typedef struct config {
+    symset     *defs;           /* symbols to treat as defined */
+    symset     *undefs;         /* symbols to treat as undefined */
+    ppproc     *ppp;            /* the preprocessor using these symbols */
+} config;
+
 /* Display a warning message regarding command-line syntax.
  */
 static void warn(char const *fmt, ...)
@@ -54,6 +156,16 @@ static void warn(char const *fmt, ...)
     fputs("\n", stderr);
 }
 
+/* Exit the program. When handling a server request, the exit code is
+ * sent back to the client first.
+ */
+static void finish(int exitcode)
+{
+    if (settings.request)
+        endrequest(exitcode);
+    exit(exitcode);
+}
+
 /* Display an error message regarding command-line syntax and exit.
  */
 static void fail(char const *fmt, ...)
@@ -64,7 +176,23 @@ static void fail(char const *fmt, ...)
     fputs("cppp: ", stderr);
     vfprintf(stderr, fmt, args);
     fputs("\nTry \"cppp --help\" for more information.\n", stderr);
-    exit(EXIT_FAILURE);
+    finish(EXIT_FAILURE);
+}
+
+/* Returns true if the argument of -D or -U is a pattern rather than a
+ * single symbol, meaning that it contains a wildcard. A pattern can
+ * otherwise only contain the characters of an identifier.
+ */
+static int ispattern(char const *arg)
+{
+    char const *p;
+
+    if (!strpbrk(arg, "*?"))
+        return FALSE;
+    for (p = arg ; *p ; ++p)
+        if (!_issym(*p) && *p != '*' && *p != '?')
+            fail("invalid symbol pattern: %s", arg);
+    return TRUE;
 }
 
 /* Parse the command-line options, storing the specified symbols to
@@ -87,10 +215,10 @@ static int readcmdline(int argc, char *argv[], symset *defs, symset *undefs)
             fputs(yowzitch1, stdout);
             fputs(yowzitch2, stdout);
             fputs(yowzitch3, stdout);
-            exit(EXIT_SUCCESS);
+            finish(EXIT_SUCCESS);
         } else if (!strcmp(argv[i], "--version")) {
             fputs(vourzhon, stdout);
-            exit(EXIT_SUCCESS);
+            finish(EXIT_SUCCESS);
         }
         if (!strcmp(argv[i], "--")) {
             for (++i ; i < argc ; ++i)
@@ -116,10 +244,24 @@ static int readcmdline(int argc, char *argv[], symset *defs, symset *undefs)
             } else {
                 value = 1;
             }
-            if (removesymbolfromset(undefs, arg))
-                warn("defining undefined symbol %s", arg);
-            else if (removesymbolfromset(defs, arg))
-                warn("defining already-defined symbol %s", arg);
+            if (ispattern(arg)) {
+                if (removepatternfromset(undefs, arg)) {
+                    if (!settings.request)
+                        warn("defining undefined pattern %s", arg);
+                } else if (removepatternfromset(defs, arg)) {
+                    if (!settings.request)
+                        warn("defining already-defined pattern %s", arg);
+                }
+                addpatterntoset(defs, arg, value);
+                continue;
+            }
+            if (removesymbolfromset(undefs, arg)) {
+                if (!settings.request)
+                    warn("defining undefined symbol %s", arg);
+            } else if (removesymbolfromset(defs, arg)) {
+                if (!settings.request)
+                    warn("defining already-defined symbol %s", arg);
+            }
             addsymboltoset(defs, arg, value);
         } else if (argv[i][1] == 'U') {
             arg = argv[i] + 2;
@@ -129,50 +271,1106 @@ static int readcmdline(int argc, char *argv[], symset *defs, symset *undefs)
                 else
                     fail("missing argument to -U");
             }
-            if (removesymbolfromset(defs, arg))
-                warn("undefining defined symbol %s", arg);
-            else if (removesymbolfromset(undefs, arg))
-                warn("undefining already-undefined symbol %s", arg);
+            if (ispattern(arg)) {
+                if (removepatternfromset(defs, arg)) {
+                    if (!settings.request)
+                        warn("undefining defined pattern %s", arg);
+                } else if (removepatternfromset(undefs, arg)) {
+                    if (!settings.request)
+                        warn("undefining already-undefined pattern %s", arg);
+                }
+                addpatterntoset(undefs, arg, 0L);
+                continue;
+            }
+            if (removesymbolfromset(defs, arg)) {
+                if (!settings.request)
+                    warn("undefining defined symbol %s", arg);
+            } else if (removesymbolfromset(undefs, arg)) {
+                if (!settings.request)
+                    warn("undefining already-undefined symbol %s", arg);
+            }
             addsymboltoset(undefs, arg, 0L);
         } else if (!strcmp(argv[i], "-t") || !strcmp(argv[i], "--trigraphs")) {
             enabletrigraphs(TRUE);
         } else if (!strcmp(argv[i], "-c") || !strcmp(argv[i], "--multichar")) {
             allowmultichars(TRUE);
+        } else if (argv[i][1] == 'j' || !strcmp(argv[i], "--jobs")) {
+            arg = argv[i][1] == 'j' ? argv[i] + 2 : "";
+            if (!*arg) {
+                if (i + 1 < argc)
+                    arg = argv[++i];
+                else
+                    fail("missing argument to %s", argv[i]);
+            }
+            value = strtol(arg, &p, 10);
+            if (*p || value < 1 || value > 1024)
+                fail("invalid number of jobs: %s", arg);
+            setjobcount((int)value);
+            settings.jobs = (int)value;
+        } else if (!strcmp(argv[i], "--emit-edits")) {
+            settings.edits = TRUE;
+        } else if (!strcmp(argv[i], "--check")) {
+            settings.check = TRUE;
+        } else if (!strcmp(argv[i], "--list-affected")) {
+            settings.check = TRUE;
+            settings.listaffected = TRUE;
+        } else if (!strcmp(argv[i], "--build-index")) {
+            settings.buildindex = TRUE;
+        } else if (!strcmp(argv[i], "--apply-index")) {
+            settings.applyindex = TRUE;
+        } else if (!strcmp(argv[i], "--deps")) {
+            settings.deps = TRUE;
+        } else if (!strcmp(argv[i], "--variants")) {
+            if (i + 1 >= argc)
+                fail("missing argument to --variants");
+            for (p = strtok(argv[++i], ",") ; p ; p = strtok(NULL, ",")) {
+                settings.variants = reallocate(settings.variants,
+                        (settings.variantcount + 1) * sizeof(char*));
+                settings.variants[settings.variantcount++] = p;
+            }
+            if (!settings.variantcount)
+                fail("no symbols given to --variants");
+        } else if (!strcmp(argv[i], "--stats")) {
+            settings.stats = TRUE;
+        } else if (!strcmp(argv[i], "--perf-counters")) {
+            settings.perfcounters = TRUE;
+        } else if (!strcmp(argv[i], "--files-from")) {
+            if (i + 1 < argc)
+                settings.filesfrom = argv[++i];
+            else
+                fail("missing argument to --files-from");
+        } else if (!strcmp(argv[i], "--compile-db")) {
+            if (i + 1 < argc)
+                settings.compiledb = argv[++i];
+            else
+                fail("missing argument to --compile-db");
+        } else if (!strcmp(argv[i], "--tar-in")) {
+            settings.tarin = TRUE;
+        } else if (!strcmp(argv[i], "--tar-out")) {
+            settings.tarout = TRUE;
+        } else if (!strcmp(argv[i], "--dedup")) {
+            if (i + 1 >= argc)
+                fail("missing argument to --dedup");
+            arg = argv[++i];
+            if (!strcmp(arg, "copy"))
+                settings.dedup = dedupCopy;
+            else if (!strcmp(arg, "link"))
+                settings.dedup = dedupLink;
+            else if (!strcmp(arg, "reflink"))
+                settings.dedup = dedupReflink;
+            else
+                fail("invalid argument to --dedup: %s", arg);
+        } else if (!strcmp(argv[i], "--journal")) {
+            if (i + 1 < argc)
+                settings.journal = argv[++i];
+            else
+                fail("missing argument to --journal");
+        } else if (!strcmp(argv[i], "--emit-specialized")) {
+            if (i + 1 < argc)
+                settings.specialized = argv[++i];
+            else
+                fail("missing argument to --emit-specialized");
+        } else if (!strcmp(argv[i], "--shard")) {
+            if (i + 1 >= argc)
+                fail("missing argument to --shard");
+            arg = argv[++i];
+            value = strtol(arg, &p, 10);
+            if (p == arg || *p != '/' || value < 0 || value >= INT_MAX)
+                fail("invalid shard: %s", arg);
+            settings.shard = (int)value;
+            value = strtol(p + 1, &p, 10);
+            if (*p || value <= settings.shard || value > INT_MAX)
+                fail("invalid shard: %s", arg);
+            settings.shardcount = (int)value;
+        } else if (!strcmp(argv[i], "--server")) {
+            if (i + 1 < argc)
+                settings.server = argv[++i];
+            else
+                fail("missing argument to --server");
+        } else if (!strcmp(argv[i], "--watch")) {
+            settings.watch = TRUE;
         } else {
             fail("invalid option: %s", argv[i]);
         }
     }
+    if (settings.watch && (settings.check || settings.edits))
+        fail("--watch cannot be used with --check, --list-affected,"
+             " or --emit-edits");
     return j;
 }
 
-/* Run the partial preprocessor. The details of the input and output
- * depend on the number of command-line arguments. With no arguments,
- * standard input is processed to standard output. With one argument,
- * the file is processed to standard output. With two file arguments,
- * the first file is processed to the second file. With one or more
- * file arguments followed by a directory argument, the files are
- * processed to files with the same name in the given directory.
+/* The SOURCE files to process, taken first from the command line and
+ * then from the file named by --files-from. The file is read one name
+ * at a time, so that the list is never held in memory all at once.
  */
-int main(int argc, char *argv[])
+typedef struct filelist {
+    char      **args;           /* the filenames left on the command line */
+    int         count;          /* the number of filenames left in args */
+    FILE       *fp;             /* the list file, or NULL */
+    int         sep;            /* the list's separator, or EOF if unknown */
+    char       *name;           /* buffer holding a name read from the list */
+    size_t      size;           /* the size of the name buffer */
+} filelist;
+
+/* Prepares to iterate over the SOURCE files given on the command line
+ * and in the --files-from list.
+ */
+static void openfilelist(filelist *fl, int count, char *args[])
+{
+    fl->args = args;
+    fl->count = count;
+    fl->fp = NULL;
+    fl->sep = EOF;
+    fl->name = NULL;
+    fl->size = 0;
+    if (settings.filesfrom) {
+        if (!strcmp(settings.filesfrom, "-")) {
+            fl->fp = stdin;
+        } else if (!(fl->fp = fopen(settings.filesfrom, "rb"))) {
+            perror(settings.filesfrom);
+            finish(EXIT_FAILURE);
+        }
+    }
+}
+
+/* Returns true if the list holds no files at all, in which case the
+ * standard input is processed instead.
+ */
+static int filelistempty(filelist const *fl)
+{
+    return fl->count == 0 && !fl->fp;
+}
+
+/* Reads the next name from the list file. Names are terminated by
+ * either newlines or NUL bytes, whichever appears first in the file.
+ * The return value is NULL at the end of the list.
+ */
+static char const *readlistname(filelist *fl)
+{
+    size_t n;
+    int ch;
+
+    n = 0;
+    for (;;) {
+        ch = getc(fl->fp);
+        if (ch == EOF) {
+            if (n == 0)
+                return NULL;
+            break;
+        }
+        if (ch == '\0' || ch == '\n') {
+            if (fl->sep == EOF)
+                fl->sep = ch;
+            if (ch == fl->sep || ch == '\0')
+                break;
+        }
+        if (n + 1 >= fl->size) {
+            fl->size = fl->size ? 2 * fl->size : 256;
+            fl->name = reallocate(fl->name, fl->size);
+        }
+        fl->name[n++] = ch;
+    }
+    if (!fl->name) {
+        fl->size = 256;
+        fl->name = allocate(fl->size);
+    }
+    fl->name[n] = '\0';
+    return fl->name;
+}
+
+/* Returns true if the named file belongs to the shard selected with
+ * --shard. The content key of the name is used, so that every process
+ * given the same list agrees on which shard each file belongs to.
+ */
+static int inshard(char const *filename)
+{
+    contentkey key;
+
+    if (!settings.shardcount)
+        return TRUE;
+    initcontentkey(&key);
+    addtocontentkey(&key, filename, strlen(filename));
+    return (int)(key.hash[0] % settings.shardcount) == settings.shard;
+}
+
+/* Returns the name of the next SOURCE file to process, or NULL if
+ * there are none left. Empty names and files outside of the selected
+ * shard are skipped.
+ */
+static char const *nextfile(filelist *fl)
+{
+    char const *filename;
+
+    for (;;) {
+        if (fl->count > 0) {
+            filename = *fl->args++;
+            --fl->count;
+        } else if (!fl->fp || !(filename = readlistname(fl))) {
+            return NULL;
+        }
+        if (*filename && inshard(filename))
+            return filename;
+    }
+}
+
+/* Closes the list file. The return value is false if an error
+ * occurred while reading it.
+ */
+static int closefilelist(filelist *fl)
+{
+    int ret;
+
+    ret = TRUE;
+    if (fl->fp) {
+        if (ferror(fl->fp)) {
+            perror(settings.filesfrom);
+            ret = FALSE;
+        }
+        if (fl->fp != stdin)
+            fclose(fl->fp);
+    }
+    deallocate(fl->name);
+    return ret;
+}
+
+/* Returns a newly allocated string holding the pathname within
+ * dirname that the output for the given file is written to. The
+ * file's relative pathname is preserved, less any leading slashes.
+ * NULL is returned if the pathname refers to a parent directory, and
+ * so would lead outside of dirname.
+ */
+static char *destfilename(char const *dirname, char const *filename)
+{
+    char const *p;
+    char *destname;
+
+    while (*filename == '/')
+        ++filename;
+    for (p = filename ; p ; p = strchr(p, '/')) {
+        while (*p == '/')
+            ++p;
+        if (p[0] == '.' && p[1] == '.' && (p[2] == '/' || p[2] == '\0'))
+            return NULL;
+    }
+    destname = allocate(strlen(dirname) + strlen(filename) + 2);
+    sprintf(destname, "%s/%s", dirname, filename);
+    return destname;
+}
+
+/* Returns a newly allocated string holding the name of the index file
+ * for the given source file.
+ */
+static char *indexfilename(char const *filename)
+{
+    char *indexname;
+
+    indexname = allocate(strlen(filename) + sizeof INDEX_SUFFIX);
+    strcpy(indexname, filename);
+    strcat(indexname, INDEX_SUFFIX);
+    return indexname;
+}
+
+/* Opens the index file for the given source file, if indexes are
+ * being applied. The return value is NULL if there is no index file
+ * to use.
+ */
+static FILE *openindex(char const *filename)
+{
+    FILE *indexfile;
+    char *indexname;
+
+    if (!settings.applyindex)
+        return NULL;
+    indexname = indexfilename(filename);
+    indexfile = fopen(indexname, "rb");
+    deallocate(indexname);
+    return indexfile;
+}
+
+/* Writes an index file for each of the listed files.
+ */
+static int buildindexes(filelist *files)
+{
+    FILE *infile, *indexfile;
+    char const *filename;
+    char *indexname;
+    int ret;
+
+    ret = TRUE;
+    while ((filename = nextfile(files))) {
+        seterrorfile(filename);
+        if (!(infile = fopen(filename, "r"))) {
+            perror(filename);
+            ret = FALSE;
+            continue;
+        }
+        indexname = indexfilename(filename);
+        if (!(indexfile = fopen(indexname, "wb"))) {
+            perror(indexname);
+            ret = FALSE;
+        } else {
+            if (!buildindex(infile, indexfile)) {
+                fprintf(stderr, "%s: unable to build index\n", filename);
+                ret = FALSE;
+            }
+            if (fclose(indexfile)) {
+                perror(indexname);
+                ret = FALSE;
+            }
+        }
+        deallocate(indexname);
+        fclose(infile);
+    }
+    return ret;
+}
+
+/* Returns true if the filename has an extension used for C or C++
+ * source files.
+ */
+static int issourcefile(char const *filename)
+{
+    static char const *const extensions[] = {
+        ".c", ".h", ".cc", ".hh", ".cpp", ".hpp", ".cxx", ".hxx", ".C", ".H"
+    };
+    char const *ext;
+    int i;
+
+    ext = strrchr(filename, '.');
+    if (!ext)
+        return FALSE;
+    for (i = 0 ; i < sizearray(extensions) ; ++i)
+        if (!strcmp(ext, extensions[i]))
+            return TRUE;
+    return FALSE;
+}
+
+/* Adds the named file to the dependency index. If it is a directory,
+ * every C or C++ source file within it is added instead, recursively.
+ * explicit is true if the file was named on the command line, in
+ * which case it is added regardless of its name.
+ */
+static int adddeps(ppproc *ppp, depindex *deps, char const *filename,
+                   int explicit)
+{
+    FILE *infile;
+    char **list;
+    char *path;
+    int ret, i;
+
+    if (fileisdir(filename)) {
+        if (!(list = listdirectory(filename))) {
+            perror(filename);
+            return FALSE;
+        }
+        ret = TRUE;
+        for (i = 0 ; list[i] ; ++i) {
+            path = allocate(strlen(filename) + strlen(list[i]) + 2);
+            sprintf(path, "%s/%s", filename, list[i]);
+            if (!adddeps(ppp, deps, path, FALSE))
+                ret = FALSE;
+            deallocate(path);
+            free(list[i]);
+        }
+        free(list);
+        return ret;
+    }
+    if (!explicit && !issourcefile(filename))
+        return TRUE;
+    seterrorfile(filename);
+    if (!(infile = fopen(filename, "r"))) {
+        perror(filename);
+        return FALSE;
+    }
+    adddepfile(deps, filename);
+    collectdeps(ppp, infile, deps);
+    fclose(infile);
+    return TRUE;
+}
+
+/* Outputs the dependency index for all of the listed files.
+ */
+static int listdeps(ppproc *ppp, filelist *files)
+{
+    depindex *deps;
+    char const *filename;
+    int ret;
+
+    deps = initdepindex();
+    ret = TRUE;
+    if (filelistempty(files)) {
+        seterrorfile(NULL);
+        adddepfile(deps, "-");
+        collectdeps(ppp, stdin, deps);
+    }
+    while ((filename = nextfile(files)))
+        if (!adddeps(ppp, deps, filename, TRUE))
+            ret = FALSE;
+    if (!writedepindex(deps, stdout)) {
+        perror("stdout");
+        ret = FALSE;
+    }
+    freedepindex(deps);
+    return ret;
+}
+
+/* Verify that no -D or -U pattern matches one of the symbols listed
+ * with --variants. Each variant overrides the symbols it analyzes by
+ * name, but a pattern would still decide the value of a symbol that
+ * the variant leaves unspecified.
+ */
+static void checkvariantpatterns(config const *cfg)
 {
-    FILE *infile, *outfile;
-    char const *filename, *dirname;
     symset *defs, *undefs;
-    ppproc *ppp;
-    int exitcode;
     int i;
 
-    defs = initsymset();    
-    undefs = initsymset();    
+    defs = initsymset();
+    undefs = initsymset();
+    copysymbols(defs, cfg->defs);
+    copysymbols(undefs, cfg->undefs);
+    for (i = 0 ; i < settings.variantcount ; ++i) {
+        removesymbolfromset(defs, settings.variants[i]);
+        removesymbolfromset(undefs, settings.variants[i]);
+    }
+    for (i = 0 ; i < settings.variantcount ; ++i)
+        if (resolvesymbol(defs, undefs, settings.variants[i], NULL))
+            fail("%s: matched by a -D or -U pattern, cannot be used"
+                 " with --variants", settings.variants[i]);
+    freesymset(defs);
+    freesymset(undefs);
+}
+
+/* Analyze the variant outputs of the given file across all
+ * combinations of the symbols listed with --variants, with the other
+ * symbols of the configuration in effect throughout, and report the
+ * distinct outputs to standard output. If dirname is not NULL, the
+ * output of each distinct variant is written to that directory. The
+ * return value is false if a file could not be read or written.
+ */
+static int listvariants(config const *cfg, char const *filename,
+                        char const *dirname)
+{
+    varset *vs;
+    FILE *infile, *outfile;
+    char const *setting;
+    char *outname;
+    double total;
+    int ret, i, n;
+
+    seterrorfile(filename);
+    if (!filename) {
+        infile = stdin;
+    } else if (!(infile = fopen(filename, "r"))) {
+        perror(filename);
+        return FALSE;
+    }
+    vs = analyzevariants(infile, cfg->defs, cfg->undefs,
+                         settings.variants, settings.variantcount);
+    if (infile != stdin)
+        fclose(infile);
+    if (!vs) {
+        perror(filename ? filename : "stdin");
+        return FALSE;
+    }
+
+    total = 0;
+    for (n = 0 ; n < getvariantcount(vs) ; ++n)
+        total += getvariantweight(vs, n);
+    printf("%d distinct outputs from %.0f combinations\n",
+           getvariantcount(vs), total);
+    for (n = 0 ; n < getvariantcount(vs) ; ++n) {
+        printf("variant %d (%.0f combinations):", n + 1,
+               getvariantweight(vs, n));
+        setting = getvariantsettings(vs, n);
+        for (i = 0 ; i < settings.variantcount ; ++i)
+            if (setting[i] != '-')
+                printf(" -%c%s", setting[i], settings.variants[i]);
+        putchar('\n');
+    }
+
+    ret = TRUE;
+    if (dirname) {
+        filename = getbasefilename(filename);
+        outname = allocate(strlen(dirname) + strlen(filename) + 16);
+        for (n = 0 ; n < getvariantcount(vs) ; ++n) {
+            sprintf(outname, "%s/%d-%s", dirname, n + 1, filename);
+            if (!(outfile = fopen(outname, "w"))) {
+                perror(outname);
+                ret = FALSE;
+                break;
+            }
+            writevariant(vs, n, outfile);
+            if (fclose(outfile)) {
+                perror(outname);
+                ret = FALSE;
+                break;
+            }
+        }
+        deallocate(outname);
+    }
+    freevarset(vs);
+    return ret;
+}
+
+/* An output file, identified by the contents of its input.
+ */
+typedef struct dedupentry {
+    struct dedupentry *next;    /* the next entry in the same bucket */
+    contentkey  key;            /* the contents of the input file */
+    char       *inname;         /* the name of the input file */
+    char       *outname;        /* the name of the output file */
+} dedupentry;
+
+/* The output files written so far, in a hash table that is indexed by
+ * the contents of their inputs.
+ */
+static struct {
+    dedupentry **buckets;       /* the hash table's chains of entries */
+    int         bucketcount;    /* the number of chains in the table */
+    int         count;          /* the number of entries in the table */
+} dedup;
+
+/* Reads the contents of a file, computing its content key. The return
+ * value is false if the file could not be read.
+ */
+static int hashcontents(FILE *fp, contentkey *key)
+{
+    char buf[8192];
+    size_t n;
+
+    initcontentkey(key);
+    while ((n = fread(buf, 1, sizeof buf, fp)) > 0)
+        addtocontentkey(key, buf, n);
+    return !ferror(fp);
+}
+
+/* Reads the entire contents of a file into memory, computing its
+ * content key along the way. The return value is the allocated
+ * buffer, or NULL if the file could not be read.
+ */
+static char *readcontents(FILE *fp, contentkey *key, size_t *size)
+{
+    char *buf;
+    size_t allocated, n;
+
+    initcontentkey(key);
+    allocated = 65536;
+    buf = allocate(allocated);
+    *size = 0;
+    for (;;) {
+        n = fread(buf + *size, 1, allocated - *size, fp);
+        addtocontentkey(key, buf + *size, n);
+        *size += n;
+        if (*size < allocated)
+            break;
+        allocated *= 2;
+        buf = reallocate(buf, allocated);
+    }
+    if (ferror(fp)) {
+        deallocate(buf);
+        return NULL;
+    }
+    return buf;
+}
+
+/* Returns true if the file named filename contains exactly the size
+ * bytes at buf.
+ */
+static int samecontents(char const *filename, char const *buf, size_t size)
+{
+    FILE *fp;
+    char cmp[8192];
+    size_t n;
+    int ret;
+
+    if (!(fp = fopen(filename, "rb")))
+        return FALSE;
+    ret = TRUE;
+    while (ret && (n = fread(cmp, 1, sizeof cmp, fp)) > 0) {
+        if (n > size || memcmp(cmp, buf, n))
+            ret = FALSE;
+        buf += n;
+        size -= n;
+    }
+    if (ferror(fp) || size)
+        ret = FALSE;
+    fclose(fp);
+    return ret;
+}
+
+/* Returns the name of the output file for an earlier input file with
+ * the same contents as the size bytes at buf, or NULL if there was
+ * none. Since different contents can have the same key, the earlier
+ * input is compared byte for byte before it is accepted.
+ */
+static char const *findcontents(contentkey const *key,
+                                char const *buf, size_t size)
+{
+    dedupentry *entry;
+
+    if (!dedup.bucketcount)
+        return NULL;
+    entry = dedup.buckets[key->hash[0] % dedup.bucketcount];
+    for ( ; entry ; entry = entry->next)
+        if (entry->key.size == key->size && entry->key.hash[0] == key->hash[0]
+                                         && entry->key.hash[1] == key->hash[1]
+                                         && samecontents(entry->inname,
+                                                         buf, size))
+            return entry->outname;
+    return NULL;
+}
+
+/* Records the names of an input file with the given contents and of
+ * its output file. The table is enlarged as needed to keep the chains
+ * short.
+ */
+static void addcontents(contentkey const *key, char const *inname,
+                        char const *outname)
+{
+    dedupentry **buckets;
+    dedupentry *entry, *next;
+    int count, i, n;
+
+    if (dedup.count >= dedup.bucketcount) {
+        count = dedup.bucketcount ? 2 * dedup.bucketcount : 256;
+        buckets = allocate(count * sizeof *buckets);
+        for (i = 0 ; i < count ; ++i)
+            buckets[i] = NULL;
+        for (i = 0 ; i < dedup.bucketcount ; ++i) {
+            for (entry = dedup.buckets[i] ; entry ; entry = next) {
+                next = entry->next;
+                n = entry->key.hash[0] % count;
+                entry->next = buckets[n];
+                buckets[n] = entry;
+            }
+        }
+        deallocate(dedup.buckets);
+        dedup.buckets = buckets;
+        dedup.bucketcount = count;
+    }
+    entry = allocate(sizeof *entry);
+    entry->key = *key;
+    entry->inname = allocate(strlen(inname) + 1);
+    strcpy(entry->inname, inname);
+    entry->outname = allocate(strlen(outname) + 1);
+    strcpy(entry->outname, outname);
+    n = key->hash[0] % dedup.bucketcount;
+    entry->next = dedup.buckets[n];
+    dedup.buckets[n] = entry;
+    ++dedup.count;
+}
+
+/* Discards the record of the output files.
+ */
+static void freecontents(void)
+{
+    dedupentry *entry, *next;
+    int i;
+
+    for (i = 0 ; i < dedup.bucketcount ; ++i) {
+        for (entry = dedup.buckets[i] ; entry ; entry = next) {
+            next = entry->next;
+            deallocate(entry->inname);
+            deallocate(entry->outname);
+            deallocate(entry);
+        }
+    }
+    deallocate(dedup.buckets);
+    dedup.buckets = NULL;
+    dedup.bucketcount = 0;
+    dedup.count = 0;
+}
+
+/* Writes a copy of the file named original to the file named outname.
+ */
+static int copyfile(char const *original, char const *outname)
+{
+    FILE *infile, *outfile;
+    char buf[8192];
+    size_t n;
+    int ret;
+
+    if (!(infile = fopen(original, "rb"))) {
+        perror(original);
+        return FALSE;
+    }
+    if (!(outfile = fopen(outname, "wb"))) {
+        perror(outname);
+        fclose(infile);
+        return FALSE;
+    }
+    ret = TRUE;
+    while ((n = fread(buf, 1, sizeof buf, infile)) > 0) {
+        if (fwrite(buf, 1, n, outfile) != n)
+            break;
+    }
+    if (ferror(infile)) {
+        perror(original);
+        ret = FALSE;
+    }
+    if (fclose(outfile) || n > 0) {
+        perror(outname);
+        ret = FALSE;
+    }
+    fclose(infile);
+    return ret;
+}
+
+/* Makes the file named outname a duplicate of the output file named
+ * original, in the manner selected with --dedup. A link or clone that
+ * cannot be made is replaced with a copy.
+ */
+static int duplicatefile(char const *original, char const *outname)
+{
+    if (!strcmp(original, outname))
+        return TRUE;
+    if (settings.dedup == dedupLink && linkfile(original, outname))
+        return TRUE;
+    if (settings.dedup == dedupReflink && clonefile(original, outname))
+        return TRUE;
+    return copyfile(original, outname);
+}
+
+/* The journal of completed files, if one is in use.
+ */
+static journal *completed;
+
+/* Returns a key identifying a symbol configuration, together with the
+ * other settings that affect the output.
+ */
+static void getconfigkey(symset const *defs, symset const *undefs,
+                         contentkey *key)
+{
+    contentkey d, u;
+    char buf[128];
+    int n;
+
+    getsymsetkey(defs, &d);
+    getsymsetkey(undefs, &u);
+    n = sprintf(buf, "%lu %lx %lx %lu %lx %lx %d %d", d.size, d.hash[0],
+                d.hash[1], u.size, u.hash[0], u.hash[1],
+                trigraphsenabledp(), multicharsallowedp());
+    initcontentkey(key);
+    addtocontentkey(key, buf, n);
+}
+
+/* Returns true if the journal shows that the output file was already
+ * produced from the same input and configuration, and that it still
+ * has the contents it was given.
+ */
+static int isjournaled(contentkey const *config, contentkey const *in,
+                       char const *inname, char const *outname)
+{
+    FILE *fp;
+    contentkey recorded, current;
+    int ret;
+
+    if (!findjournal(completed, inname, outname, in, config, &recorded))
+        return FALSE;
+    if (!(fp = fopen(outname, "rb")))
+        return FALSE;
+    ret = hashcontents(fp, &current) && current.size == recorded.size
+                                     && current.hash[0] == recorded.hash[0]
+                                     && current.hash[1] == recorded.hash[1];
+    fclose(fp);
+    return ret;
+}
+
+/* Records a completed file in the journal, along with the key of its
+ * output. The return value is false if an error occurs.
+ */
+static int journalfile(contentkey const *config, contentkey const *in,
+                       char const *inname, char const *outname)
+{
+    FILE *fp;
+    contentkey out;
+
+    if (!(fp = fopen(outname, "rb"))) {
+        perror(outname);
+        return FALSE;
+    }
+    if (!hashcontents(fp, &out)) {
+        perror(outname);
+        fclose(fp);
+        return FALSE;
+    }
+    fclose(fp);
+    if (!addjournal(completed, inname, outname, in, config, &out)) {
+        perror(settings.journal);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/* Partially preprocesses the file named inname, writing the results
+ * to the file named outname. With --dedup, an input whose contents
+ * match an earlier input's is not processed again, and its output is
+ * made a duplicate of the earlier one's instead. (Any existing output
+ * file is removed first, in case it is a link left by an earlier run.)
+ * With --journal, config identifies the symbol configuration, and a
+ * file that the journal shows is already done is skipped; otherwise
+ * the file is recorded once it is done, provided that no errors were
+ * found in it. In either case, the input is read into memory and its
+ * key computed in a single pass, and the contents are processed from
+ * there. The return value is false if either file could not be
+ * opened or written to.
+ */
+static int processfile(ppproc *ppp, contentkey const *config,
+                       char const *inname, char const *outname)
+{
+    FILE *infile, *outfile, *indexfile;
+    char const *original;
+    contentkey key;
+    char *buf;
+    size_t size;
+    int journaling, mark;
+
+    journaling = completed && config;
+    seterrorfile(inname);
+    if (!(infile = fopen(inname, "r"))) {
+        perror(inname);
+        return FALSE;
+    }
+    buf = NULL;
+    if (settings.dedup || journaling) {
+        buf = readcontents(infile, &key, &size);
+        if (!buf)
+            perror(inname);
+        fclose(infile);
+        infile = NULL;
+        if (!buf)
+            return FALSE;
+        if (journaling && isjournaled(config, &key, inname, outname)) {
+            deallocate(buf);
+            if (settings.dedup)
+                addcontents(&key, inname, outname);
+            return TRUE;
+        }
+    }
+    if (settings.dedup) {
+        if ((original = findcontents(&key, buf, size))) {
+            deallocate(buf);
+            if (!duplicatefile(original, outname))
+                return FALSE;
+            return !journaling || journalfile(config, &key, inname, outname);
+        }
+        remove(outname);
+    }
+    if (!(outfile = fopen(outname, "w"))) {
+        perror(outname);
+        if (infile)
+            fclose(infile);
+        deallocate(buf);
+        return FALSE;
+    }
+    indexfile = openindex(inname);
+    useindex(ppp, indexfile);
+    mark = geterrormark();
+    if (buf)
+        partialpreprocessbuffer(ppp, buf, size, writetofile, outfile, inname);
+    else
+        partialpreprocess(ppp, infile, outfile, inname);
+    if (indexfile)
+        fclose(indexfile);
+    if (infile)
+        fclose(infile);
+    deallocate(buf);
+    if (fclose(outfile)) {
+        perror(outname);
+        return FALSE;
+    }
+    if (settings.dedup)
+        addcontents(&key, inname, outname);
+    if (journaling && !errorsincemark(mark))
+        return journalfile(config, &key, inname, outname);
+    return TRUE;
+}
+
+/* Run the partial preprocessor over each of the listed files, writing
+ * an edit script for all of them to standard output. The return value
+ * is false if any of the files could not be read.
+ */
+static int emitedits(ppproc *ppp, filelist *files)
+{
+    FILE *infile;
+    char const *filename;
+    int ret;
 
-    argc = readcmdline(argc, argv, defs, undefs);
+    outputedits(ppp, TRUE);
+    if (filelistempty(files)) {
+        seterrorfile(NULL);
+        partialpreprocess(ppp, stdin, stdout, NULL);
+        return TRUE;
+    }
+    ret = TRUE;
+    while ((filename = nextfile(files))) {
+        seterrorfile(filename);
+        if (!(infile = fopen(filename, "r"))) {
+            perror(filename);
+            ret = FALSE;
+            continue;
+        }
+        partialpreprocess(ppp, infile, stdout, filename);
+        fclose(infile);
+    }
+    return ret;
+}
+
+/* Determine which of the listed files would be altered by the partial
+ * preprocessor, without producing output. If listing is enabled, the
+ * name of each such file is written to standard output; otherwise,
+ * processing stops with the first one. A file that cannot be read is
+ * reported and skipped. The return value is 0 if no files would be
+ * altered, 1 if any would be, or 2 if an error occurred, in the manner
+ * of cmp(1).
+ */
+static int checkfiles(ppproc *ppp, filelist *files)
+{
+    FILE *infile;
+    char const *filename;
+    int ret;
+
+    ret = 0;
+    if (filelistempty(files)) {
+        seterrorfile(NULL);
+        if (checkpreprocess(ppp, stdin)) {
+            ret = 1;
+            if (settings.listaffected)
+                puts("-");
+        }
+    }
+    while ((filename = nextfile(files))) {
+        seterrorfile(filename);
+        if (!(infile = fopen(filename, "r"))) {
+            error(errFileIO);
+            continue;
+        }
+        if (checkpreprocess(ppp, infile)) {
+            ret = 1;
+            if (settings.listaffected)
+                puts(filename);
+        }
+        fclose(infile);
+        if (ret && !settings.listaffected)
+            break;
+    }
+    return geterrormark() > 0 ? 2 : ret;
+}
+
+/* Selects the archive members to be processed.
+ */
+static int tarselect(char const *name, void *data)
+{
+    (void)data;
+    return issourcefile(name);
+}
+
+/* Partially preprocesses an archive member.
+ */
+static int tarmember(char const *name, char const *buf, size_t size,
+                     textsink sink, void *sinkdata, void *data)
+{
+    seterrorfile(name);
+    partialpreprocessbuffer(data, buf, size, sink, sinkdata, name);
+    seterrorfile(NULL);
+    return TRUE;
+}
+
+/* Run the partial preprocessor over the C and C++ source files in a
+ * tar archive, entirely in memory, writing a new archive that is
+ * otherwise unchanged. The archive is read from SOURCE and written to
+ * DEST, or standard input and output if they are omitted. The return
+ * value is false if an error occurs.
+ */
+static int processtar(ppproc *ppp, int argc, char *argv[])
+{
+    FILE *infile, *outfile;
+    char const *inname, *outname;
+    int ret;
+
+    if (argc > 3)
+        fail("--tar-in and --tar-out take at most a SOURCE and a DEST");
+    inname = argc > 1 ? argv[1] : "stdin";
+    outname = argc > 2 ? argv[2] : "stdout";
+    infile = argc > 1 ? fopen(inname, "rb") : stdin;
+    if (!infile) {
+        perror(inname);
+        return FALSE;
+    }
+    outfile = argc > 2 ? fopen(outname, "wb") : stdout;
+    if (!outfile) {
+        perror(outname);
+        if (infile != stdin)
+            fclose(infile);
+        return FALSE;
+    }
+    ret = filtertar(infile, outfile, tarselect, tarmember, ppp);
+    if (ret < 0)
+        fprintf(stderr, "%s: not a valid tar archive\n", inname);
+    else if (ret == 0)
+        perror(ferror(outfile) ? outname : inname);
+    if (infile != stdin)
+        fclose(infile);
+    if (fflush(outfile) || (outfile != stdout && fclose(outfile))) {
+        perror(outname);
+        ret = 0;
+    }
+    return ret > 0;
+}
+
+/* Run the partial preprocessor over each of the listed files, writing
+ * the results to the same relative pathname within the directory
+ * dirname, and creating any subdirectories that are needed. The
+ * return value is false if any file could not be read or written.
+ */
+static int processlist(ppproc *ppp, contentkey const *config,
+                       filelist *files, char const *dirname)
+{
+    char const *filename;
+    char *destname;
+    int ret;
+
+    ret = TRUE;
+    while ((filename = nextfile(files))) {
+        if (!(destname = destfilename(dirname, filename))) {
+            fprintf(stderr, "%s: pathname leads outside of %s\n",
+                    filename, dirname);
+            ret = FALSE;
+            continue;
+        }
+        if (!makeparentdirs(destname)) {
+            perror(destname);
+            ret = FALSE;
+        } else if (!processfile(ppp, config, filename, destname)) {
+            ret = FALSE;
+        }
+        deallocate(destname);
+    }
+    return ret;
+}
 
-    ppp = initppproc(defs, undefs);
+/* Run the partial preprocessor on the files named on the command
+ * line. The details of the input and output depend on the number of
+ * arguments. With no arguments, standard input is processed to
+ * standard output. With one argument, the file is processed to
+ * standard output. With two file arguments, the first file is
+ * processed to the second file. With one or more file arguments
+ * followed by a directory argument, the files are processed to files
+ * with the same name in the given directory. The return value is the
+ * program's exit code.
+ */
+static int processargs(ppproc *ppp, contentkey const *config,
+                       int argc, char *argv[])
+{
+    FILE *infile, *indexfile;
+    char const *filename, *dirname;
+    char *destname;
+    int exitcode;
+    int i;
 
     exitcode = EXIT_SUCCESS;
     if (argc <= 1) {
         seterrorfile(NULL);
-        partialpreprocess(ppp, stdin, stdout);
+        partialpreprocess(ppp, stdin, stdout, NULL);
     } else if (argc == 2) {
         filename = argv[1];
         seterrorfile(filename);
@@ -180,68 +1378,727 @@ int main(int argc, char *argv[])
             perror(filename);
             return EXIT_FAILURE;
         }
-        partialpreprocess(ppp, infile, stdout);
+        indexfile = openindex(filename);
+        useindex(ppp, indexfile);
+        partialpreprocess(ppp, infile, stdout, filename);
+        if (indexfile)
+            fclose(indexfile);
         fclose(infile);
     } else if (fileisdir(argv[argc - 1])) {
-        if (!savedir()) {
-            perror(".");
-            exit(EXIT_FAILURE);
-        }
         dirname = argv[argc - 1];
         for (i = 1 ; i < argc - 1 ; ++i) {
-            filename = argv[i];
-            seterrorfile(filename);
-            if (!(infile = fopen(filename, "r"))) {
-                perror(filename);
+            filename = getbasefilename(argv[i]);
+            destname = allocate(strlen(dirname) + strlen(filename) + 2);
+            sprintf(destname, "%s/%s", dirname, filename);
+            if (!processfile(ppp, config, argv[i], destname))
                 exitcode = EXIT_FAILURE;
-                continue;
-            }
-            if (!changedir(dirname)) {
-                perror(dirname);
-                exit(EXIT_FAILURE);
-            }
-            filename = getbasefilename(filename);
-            outfile = fopen(filename, "w");
-            if (outfile) {
-                partialpreprocess(ppp, infile, outfile);
-                if (fclose(outfile)) {
-                    perror(filename);
-                    exitcode = EXIT_FAILURE;
-                }
-            } else {
-                perror(filename);
-                exitcode = EXIT_FAILURE;
-            }
-            fclose(infile);
-            restoredir();
+            deallocate(destname);
         }
-        unsavedir();
     } else if (argc == 3) {
-        filename = argv[1];
-        seterrorfile(filename);
-        if (!(infile = fopen(filename, "r"))) {
-            perror(filename);
+        if (!processfile(ppp, config, argv[1], argv[2]))
             return EXIT_FAILURE;
+    } else {
+        fail("\"%s\" is not a directory.", argv[argc - 1]);
+    }
+
+    return exitcode;
+}
+
+/* A symbol setting taken from a compiler's -D or -U flag.
+ */
+typedef struct flagsym {
+    char const *id;             /* the symbol's name, within its flag */
+    int         length;         /* the length of the name */
+    int         defined;        /* true for -D, false for -U */
+    long        value;          /* the value given with -D */
+} flagsym;
+
+/* A distinct symbol configuration, shared by all of the files in a
+ * compilation database that are compiled with the same settings.
+ */
+typedef struct fileconfig {
+    char       *key;            /* the settings, in a canonical form */
+    symset     *defs;           /* symbols to treat as defined */
+    symset     *undefs;         /* symbols to treat as undefined */
+    ppproc     *ppp;            /* the preprocessor using these symbols */
+    contentkey  configkey;      /* identifies the configuration */
+} fileconfig;
+
+/* The state of a run over a compilation database.
+ */
+typedef struct compdbrun {
+    compdb     *db;             /* the compilation database */
+    int        *configs;        /* each entry's configuration, or -1 */
+    fileconfig *list;           /* the distinct configurations */
+    int         count;          /* the number of distinct configurations */
+    char const *dirname;        /* the directory to write outputs to */
+    char       *cwd;            /* the current directory, if known */
+    int         workers;        /* the number of processes sharing the run */
+} compdbrun;
+
+/* Sorts symbol settings by name.
+ */
+static int cmpflagsyms(void const *a, void const *b)
+{
+    flagsym const *fa = a;
+    flagsym const *fb = b;
+    int r;
+
+    r = strncmp(fa->id, fb->id, fa->length < fb->length ? fa->length
+                                                        : fb->length);
+    return r ? r : fa->length - fb->length;
+}
+
+/* Collects the symbol settings made by a compiler's -D and -U flags,
+ * with later flags overriding earlier ones for the same symbol. A
+ * symbol that is given a value that is not a number is treated as
+ * unspecified, as are symbols that are set on the command line, since
+ * those take precedence. The return value is the number of settings
+ * stored in syms, which is sorted by name and must be deallocated.
+ */
+static int getflagsyms(char **args, config const *cfg, flagsym **psyms)
+{
+    flagsym *syms;
+    flagsym sym;
+    char const *arg;
+    char *p;
+    int count, valid, i, j;
+
+    syms = allocate(sizeof *syms);
+    count = 0;
+    for (i = 1 ; args[0] && args[i] ; ++i) {
+        if (args[i][0] != '-' || (args[i][1] != 'D' && args[i][1] != 'U'))
+            continue;
+        sym.defined = args[i][1] == 'D';
+        arg = args[i] + 2;
+        if (!*arg && args[i + 1])
+            arg = args[++i];
+        sym.id = arg;
+        for (sym.length = 0 ; _issym(arg[sym.length]) ; ++sym.length) ;
+        if (!sym.length || isdigit(arg[0]))
+            continue;
+        arg += sym.length;
+        sym.value = 1;
+        valid = TRUE;
+        if (!sym.defined) {
+            valid = !*arg;
+        } else if (*arg == '=') {
+            sym.value = strtol(arg + 1, &p, 0);
+            valid = p != arg + 1 && !*p;
+        } else if (*arg) {
+            valid = FALSE;
         }
-        filename = argv[2];
-        if (!(outfile = fopen(filename, "w"))) {
-            perror(filename);
-            return EXIT_FAILURE;
+        if (findsymbolinset(cfg->defs, sym.id, NULL)
+                        || findsymbolinset(cfg->undefs, sym.id, NULL))
+            continue;
+        for (j = 0 ; j < count ; ++j) {
+            if (!cmpflagsyms(&syms[j], &sym)) {
+                syms[j] = syms[--count];
+                break;
+            }
         }
-        partialpreprocess(ppp, infile, outfile);
-        fclose(infile);
-        if (fclose(outfile)) {
-            perror(filename);
-            exitcode = EXIT_FAILURE;
+        if (valid) {
+            syms = reallocate(syms, (count + 1) * sizeof *syms);
+            syms[count++] = sym;
         }
+    }
+    qsort(syms, count, sizeof *syms, cmpflagsyms);
+    *psyms = syms;
+    return count;
+}
+
+/* Returns the index of the configuration for the given compiler
+ * arguments, adding a new configuration to the run if no other file
+ * has had the same settings.
+ */
+static int internconfig(compdbrun *run, config const *cfg, char **args)
+{
+    fileconfig *fc;
+    flagsym *syms;
+    char *key;
+    size_t size;
+    int count, i, n;
+
+    count = getflagsyms(args, cfg, &syms);
+    size = 1;
+    for (i = 0 ; i < count ; ++i)
+        size += syms[i].length + 32;
+    key = allocate(size);
+    for (i = n = 0 ; i < count ; ++i) {
+        if (syms[i].defined)
+            n += sprintf(key + n, "-D%.*s=%ld ", syms[i].length, syms[i].id,
+                         syms[i].value);
+        else
+            n += sprintf(key + n, "-U%.*s ", syms[i].length, syms[i].id);
+    }
+    key[n] = '\0';
+
+    for (n = 0 ; n < run->count ; ++n)
+        if (!strcmp(run->list[n].key, key))
+            break;
+    if (n < run->count) {
+        deallocate(key);
     } else {
-        fail("\"%s\" is not a directory.", argv[argc - 1]);
+        run->list = reallocate(run->list, (n + 1) * sizeof *run->list);
+        fc = &run->list[n];
+        fc->key = key;
+        fc->defs = initsymset();
+        fc->undefs = initsymset();
+        copysymbols(fc->defs, cfg->defs);
+        copysymbols(fc->undefs, cfg->undefs);
+        for (i = 0 ; i < count ; ++i) {
+            if (syms[i].defined)
+                addsymboltoset(fc->defs, syms[i].id, syms[i].value);
+            else
+                addsymboltoset(fc->undefs, syms[i].id, 0L);
+        }
+        fc->ppp = initppproc(fc->defs, fc->undefs);
+        getconfigkey(fc->defs, fc->undefs, &fc->configkey);
+        if (settings.edits)
+            outputedits(fc->ppp, TRUE);
+        ++run->count;
     }
+    deallocate(syms);
+    return n;
+}
 
-    if (geterrormark() > 0)
+/* Processes one file from the compilation database, in the manner
+ * selected on the command line. The return value is 0 on success, 1
+ * if the file would be altered with --check, or 2 if an error occurs.
+ */
+static int compdbfile(compdbrun *run, int n)
+{
+    FILE *infile;
+    fileconfig const *fc;
+    char const *filename, *relname;
+    char *destname;
+    size_t len;
+    int ret;
+
+    fc = &run->list[run->configs[n]];
+    filename = getcompdbfile(run->db, n);
+    if (run->dirname) {
+        relname = filename;
+        len = run->cwd ? strlen(run->cwd) : 0;
+        if (len && !strncmp(filename, run->cwd, len) && filename[len] == '/')
+            relname = filename + len + 1;
+        if (!(destname = destfilename(run->dirname, relname))) {
+            fprintf(stderr, "%s: pathname leads outside of %s\n",
+                    filename, run->dirname);
+            return 2;
+        }
+        ret = 0;
+        if (!makeparentdirs(destname)) {
+            perror(destname);
+            ret = 2;
+        } else if (!processfile(fc->ppp, &fc->configkey, filename, destname)) {
+            ret = 2;
+        }
+        deallocate(destname);
+        return ret;
+    }
+
+    seterrorfile(filename);
+    if (!(infile = fopen(filename, "r"))) {
+        perror(filename);
+        return 2;
+    }
+    ret = 0;
+    if (settings.check) {
+        if (checkpreprocess(fc->ppp, infile)) {
+            ret = 1;
+            if (settings.listaffected)
+                puts(filename);
+        }
+    } else {
+        partialpreprocess(fc->ppp, infile, stdout, filename);
+    }
+    fclose(infile);
+    return ret;
+}
+
+/* Processes the share of the compilation database's files that is
+ * assigned to one worker. The return value is false if an error
+ * occurs.
+ */
+static int compdbworker(int worker, void *data)
+{
+    compdbrun *run = data;
+    int ret, i;
+
+    setjobcount(1);
+    ret = TRUE;
+    for (i = worker ; i < getcompdbcount(run->db) ; i += run->workers)
+        if (run->configs[i] >= 0 && compdbfile(run, i))
+            ret = FALSE;
+    if (completed && !syncjournal(completed)) {
+        perror(settings.journal);
+        ret = FALSE;
+    }
+    return ret && geterrormark() <= 0;
+}
+
+/* Run the partial preprocessor over every file in the compilation
+ * database, each with the symbol settings given by its compiler flags
+ * in addition to those given on the command line. The files that share
+ * the same settings share a preprocessor. With --check or --emit-edits
+ * the files are processed in order; otherwise the outputs are written
+ * under DEST as with --files-from, and the files are divided among
+ * several processes if more than one job was requested. The return
+ * value is the program's exit code.
+ */
+static int processcompdb(config const *cfg, int argc, char *argv[])
+{
+    compdbrun run;
+    FILE *fp;
+    int exitcode, r, i;
+
+    if (settings.deps || settings.buildindex || settings.variants
+                      || settings.tarin || settings.tarout
+                      || settings.filesfrom)
+        fail("--compile-db cannot be used with this mode");
+    run.dirname = NULL;
+    if (settings.check || settings.edits) {
+        if (argc > 1)
+            fail("--compile-db does not take any SOURCE arguments");
+    } else {
+        if (argc != 2 || !fileisdir(argv[1]))
+            fail("--compile-db requires a DEST directory");
+        run.dirname = argv[1];
+    }
+
+    if (!strcmp(settings.compiledb, "-"))
+        fp = stdin;
+    else if (!(fp = fopen(settings.compiledb, "r")))
+        fp = NULL;
+    run.db = fp ? readcompdb(fp) : NULL;
+    if (!run.db) {
+        if (!fp || errno)
+            perror(settings.compiledb);
+        else
+            fprintf(stderr, "%s: not a valid compilation database\n",
+                    settings.compiledb);
+        if (fp && fp != stdin)
+            fclose(fp);
+        return settings.check ? 2 : EXIT_FAILURE;
+    }
+    if (fp != stdin)
+        fclose(fp);
+
+    run.configs = allocate((getcompdbcount(run.db) + 1) * sizeof(int));
+    run.list = NULL;
+    run.count = 0;
+    for (i = 0 ; i < getcompdbcount(run.db) ; ++i)
+        run.configs[i] = inshard(getcompdbfile(run.db, i)) ?
+                internconfig(&run, cfg, getcompdbargs(run.db, i)) : -1;
+    run.cwd = getcurrentdir();
+
+    exitcode = EXIT_SUCCESS;
+    if (run.dirname) {
+        run.workers = settings.jobs > 1 ? settings.jobs : 1;
+        if (run.workers > getcompdbcount(run.db))
+            run.workers = getcompdbcount(run.db);
+        if (run.workers > 1) {
+            if (!runparallel(run.workers, compdbworker, &run))
+                exitcode = EXIT_FAILURE;
+        } else {
+            run.workers = 1;
+            if (!compdbworker(0, &run))
+                exitcode = EXIT_FAILURE;
+        }
+    } else {
+        exitcode = 0;
+        for (i = 0 ; i < getcompdbcount(run.db) ; ++i) {
+            if (run.configs[i] < 0)
+                continue;
+            r = compdbfile(&run, i);
+            if (r > exitcode)
+                exitcode = r;
+            if (settings.check && r && !settings.listaffected)
+                break;
+        }
+        if (settings.check)
+            exitcode = geterrormark() > 0 ? 2 : exitcode;
+        else
+            exitcode = exitcode || geterrormark() > 0 ?
+                                EXIT_FAILURE : EXIT_SUCCESS;
+    }
+
+    for (i = 0 ; i < run.count ; ++i) {
+        freeppproc(run.list[i].ppp);
+        freesymset(run.list[i].defs);
+        freesymset(run.list[i].undefs);
+        deallocate(run.list[i].key);
+    }
+    deallocate(run.list);
+    deallocate(run.configs);
+    free(run.cwd);
+    freecompdb(run.db);
+    return exitcode;
+}
+
+/* Run the partial preprocessor, or analyze the files in the manner
+ * selected on the command line. The SOURCE files are taken from the
+ * command line and the --files-from list, less those outside of the
+ * selected shard. When a list or a shard is in use, the outputs are
+ * written to the directory DEST, and otherwise the files are handled
+ * as described for processargs(). The return value is the program's
+ * exit code.
+ */
+static int processfiles(config const *cfg, int argc, char *argv[])
+{
+    ppproc *ppp = cfg->ppp;
+    filelist files;
+    contentkey configkey;
+    contentkey const *config;
+    char const *dirname;
+    int exitcode;
+
+    if (settings.variants) {
+        if (settings.filesfrom || settings.shardcount || settings.tarin)
+            fail("--variants cannot be used with --files-from, --shard,"
+                 " or --tar-in");
+        if (argc > 3 || (argc == 3 && !fileisdir(argv[2])))
+            fail("--variants requires a single SOURCE and a DEST directory");
+        checkvariantpatterns(cfg);
+        return listvariants(cfg, argc > 1 ? argv[1] : NULL,
+                            argc > 2 ? argv[2] : NULL) ?
+                        EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (settings.compiledb)
+        return processcompdb(cfg, argc, argv);
+
+    if (settings.tarin || settings.tarout) {
+        if (!settings.tarin || !settings.tarout)
+            fail("--tar-in and --tar-out must be used together");
+        if (settings.check || settings.deps || settings.buildindex
+                           || settings.edits || settings.filesfrom
+                           || settings.shardcount || settings.dedup)
+            fail("--tar-in and --tar-out cannot be used with other modes");
+        return processtar(ppp, argc, argv) && geterrormark() <= 0 ?
+                        EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    config = NULL;
+    if (completed) {
+        getconfigkey(cfg->defs, cfg->undefs, &configkey);
+        config = &configkey;
+    }
+    dirname = NULL;
+    if ((settings.filesfrom || settings.shardcount) && !settings.check
+                && !settings.deps && !settings.buildindex && !settings.edits) {
+        if (argc < 2 || !fileisdir(argv[argc - 1]))
+            fail("--files-from and --shard require a DEST directory");
+        dirname = argv[--argc];
+    }
+
+    openfilelist(&files, argc - 1, argv + 1);
+    if (settings.check)
+        exitcode = checkfiles(ppp, &files);
+    else if (settings.deps)
+        exitcode = listdeps(ppp, &files) ? EXIT_SUCCESS : EXIT_FAILURE;
+    else if (settings.buildindex)
+        exitcode = buildindexes(&files) ? EXIT_SUCCESS : EXIT_FAILURE;
+    else if (settings.edits)
+        exitcode = emitedits(ppp, &files) ? EXIT_SUCCESS : EXIT_FAILURE;
+    else if (dirname)
+        exitcode = processlist(ppp, config, &files, dirname) ?
+                        EXIT_SUCCESS : EXIT_FAILURE;
+    else
+        exitcode = processargs(ppp, config, argc, argv);
+    if (!closefilelist(&files))
+        exitcode = settings.check ? 2 : EXIT_FAILURE;
+    freecontents();
+
+    if (!settings.check && geterrormark() > 0)
         exitcode = EXIT_FAILURE;
-    freeppproc(ppp);
-    freesymset(defs);
-    freesymset(undefs);
+    return exitcode;
+}
+
+/* The parts of a specialized program that do not depend on the
+ * symbols.
+ */
+static char const *const specializedhead =
+    " * Partially preprocesses SOURCE, or standard input, to DEST, or\n"
+    " * standard output, with the symbols below. Build it against the\n"
+    " * cppp library, as in:\n"
+    " *\n"
+    " *     cc -I CPPPDIR -o NAME THISFILE CPPPDIR/libcppp.a -pthread\n"
+    " *\n"
+    " * Define CPPP_SPECIALIZED_LIBRARY to leave out main(), and call\n"
+    " * initspecializedppproc() from another program instead.\n"
+    " */\n"
+    "#include <stdio.h>\n"
+    "#include <stdlib.h>\n"
+    "#include \"types.h\"\n"
+    "#include \"error.h\"\n"
+    "#include \"symset.h\"\n"
+    "#include \"clexer.h\"\n"
+    "#include \"ppproc.h\"\n\n";
+static char const *const specializedinit =
+    "\n/* Returns a partial preprocessor using the symbols above.\n"
+    " */\n"
+    "ppproc *initspecializedppproc(void)\n"
+    "{\n"
+    "    static symset *defs, *undefs;\n\n"
+    "    if (!defs) {\n"
+    "        defs = initsymsetfromtable(&defined);\n"
+    "        undefs = initsymsetfromtable(&undefined);\n"
+    "    }\n";
+static char const *const specializedmain =
+    "    return initppproc(defs, undefs);\n"
+    "}\n\n"
+    "#ifndef CPPP_SPECIALIZED_LIBRARY\n\n"
+    "int main(int argc, char *argv[])\n"
+    "{\n"
+    "    FILE *infile, *outfile;\n"
+    "    ppproc *ppp;\n\n"
+    "    if (argc > 3) {\n"
+    "        fprintf(stderr, \"Usage: %s [SOURCE [DEST]]\\n\", argv[0]);\n"
+    "        return EXIT_FAILURE;\n"
+    "    }\n"
+    "    infile = stdin;\n"
+    "    outfile = stdout;\n"
+    "    if (argc > 1 && !(infile = fopen(argv[1], \"r\"))) {\n"
+    "        perror(argv[1]);\n"
+    "        return EXIT_FAILURE;\n"
+    "    }\n"
+    "    if (argc > 2 && !(outfile = fopen(argv[2], \"w\"))) {\n"
+    "        perror(argv[2]);\n"
+    "        return EXIT_FAILURE;\n"
+    "    }\n"
+    "    seterrorfile(argc > 1 ? argv[1] : NULL);\n"
+    "    ppp = initspecializedppproc();\n"
+    "    partialpreprocess(ppp, infile, outfile, argc > 1 ? argv[1] : NULL);\n"
+    "    freeppproc(ppp);\n"
+    "    if (fclose(outfile)) {\n"
+    "        perror(argc > 2 ? argv[2] : \"stdout\");\n"
+    "        return EXIT_FAILURE;\n"
+    "    }\n"
+    "    return geterrormark() > 0 ? EXIT_FAILURE : EXIT_SUCCESS;\n"
+    "}\n\n"
+    "#endif\n";
+
+/* Write the source of a program that partially preprocesses a single
+ * file with the current symbols and settings built in. The symbols are
+ * written as perfect hash tables, so the program has nothing to parse
+ * or build before it starts reading its input. The return value is
+ * false if the file could not be written.
+ */
+static int emitspecialized(config const *cfg, char const *filename)
+{
+    FILE *fp;
+
+    if (!(fp = fopen(filename, "w"))) {
+        perror(filename);
+        return FALSE;
+    }
+    fprintf(fp, "/* %s: generated by cppp --emit-specialized.\n",
+            getbasefilename(filename));
+    fputs(specializedhead, fp);
+    writesymsettable(cfg->defs, "defined", fp);
+    fputc('\n', fp);
+    writesymsettable(cfg->undefs, "undefined", fp);
+    fputs(specializedinit, fp);
+    fprintf(fp, "    enabletrigraphs(%d);\n", trigraphsenabledp());
+    fprintf(fp, "    allowmultichars(%d);\n", multicharsallowedp());
+    fputs(specializedmain, fp);
+    if (fclose(fp)) {
+        perror(filename);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/* Display the memory usage of each subsystem on standard error.
+ */
+static void showstats(void)
+{
+    memstats s;
+    int tag;
+
+    fprintf(stderr, "%-8s %9s %9s %9s %12s %12s %12s\n", "memory",
+            "allocs", "frees", "reallocs", "regrown", "in use", "peak");
+    for (tag = 0 ; tag <= memTagCount ; ++tag) {
+        getmemstats(tag, &s);
+        fprintf(stderr, "%-8s %9lu %9lu %9lu %12lu %12lu %12lu\n",
+                getmemtagname(tag), s.allocs, s.frees, s.reallocs,
+                (unsigned long)s.reallocbytes, (unsigned long)s.bytes,
+                (unsigned long)s.peak);
+    }
+}
+
+/* Display the hardware event counts for each phase of processing,
+ * divided by the number of bytes of input, on standard error. Events
+ * that could not be counted are shown as a dash.
+ */
+static void showperfcounters(void)
+{
+    unsigned long long count, bytes;
+    int phase, event;
+
+    bytes = getperfinput();
+    fprintf(stderr, "%-8s", "phase");
+    for (event = 0 ; event < eventCount ; ++event)
+        fprintf(stderr, " %9s/B", getperfeventname(event));
+    fputc('\n', stderr);
+    for (phase = 0 ; phase <= phaseCount ; ++phase) {
+        fprintf(stderr, "%-8s", getperfphasename(phase));
+        for (event = 0 ; event < eventCount ; ++event) {
+            if (getperfcount(phase, event, &count))
+                fprintf(stderr, " %11.3f",
+                        (double)count / (double)(bytes ? bytes : 1));
+            else
+                fprintf(stderr, " %11s", "-");
+        }
+        fputc('\n', stderr);
+    }
+    fprintf(stderr, "%-8s %11llu bytes\n", "input", bytes);
+}
+
+/* Handle a request received by the server. The request's arguments
+ * are parsed the same as the program's command line, and so can add
+ * to or override the server's configuration. Since each request runs
+ * in its own process, such changes only last for the one request.
+ * Options that are handled outside of processing the files are
+ * rejected, with the error going to the client.
+ */
+static int serverrequest(int argc, char *argv[], void *data)
+{
+    config *cfg = data;
+    char const *option;
+    int exitcode;
+
+    settings.request = TRUE;
+    settings.server = NULL;
+    settings.journal = NULL;
+    settings.specialized = NULL;
+    settings.perfcounters = FALSE;
+    settings.watch = FALSE;
+    argc = readcmdline(argc, argv, cfg->defs, cfg->undefs);
+    option = settings.server ? "--server"
+           : settings.journal ? "--journal"
+           : settings.specialized ? "--emit-specialized"
+           : settings.perfcounters ? "--perf-counters"
+           : settings.watch ? "--watch" : NULL;
+    if (option) {
+        warn("invalid option in request: %s", option);
+        return EXIT_FAILURE;
+    }
+    exitcode = processfiles(cfg, argc, argv);
+    if (settings.stats)
+        showstats();
+    return exitcode;
+}
+
+/* Process a single file on behalf of the watcher. Files that are not
+ * C or C++ source files are copied unchanged.
+ */
+static int watchfile(char const *srcname, char const *destname, void *data)
+{
+    if (!issourcefile(srcname))
+        return copyfile(srcname, destname);
+    return processfile(data, NULL, srcname, destname);
+}
+
+/* Run the program. With --client, the arguments are handed off to a
+ * server. Otherwise the command-line options are parsed, and either
+ * the files are processed or the server is started.
+ */
+int main(int argc, char *argv[])
+{
+    config cfg;
+    int exitcode;
+
+    if (argc > 1 && !strcmp(argv[1], "--client")) {
+        if (argc < 3)
+            fail("missing argument to --client");
+        exitcode = runclient(argv[2], argc - 3, argv + 3);
+        if (exitcode < 0) {
+            perror(argv[2]);
+            exitcode = EXIT_FAILURE;
+        }
+        return exitcode;
+    }
+
+    cfg.defs = initsymset();
+    cfg.undefs = initsymset();
+
+    argc = readcmdline(argc, argv, cfg.defs, cfg.undefs);
+
+    cfg.ppp = initppproc(cfg.defs, cfg.undefs);
+
+    if (settings.specialized) {
+        if (argc > 1)
+            fail("file arguments cannot be used with --emit-specialized");
+        exitcode = emitspecialized(&cfg, settings.specialized) ?
+                        EXIT_SUCCESS : EXIT_FAILURE;
+    } else if (settings.server) {
+        if (argc > 1)
+            fail("file arguments cannot be used with --server");
+        if (settings.journal)
+            fail("--journal cannot be used with --server");
+        exitcode = EXIT_SUCCESS;
+        if (!runserver(settings.server, serverrequest, &cfg)) {
+            perror(settings.server);
+            exitcode = EXIT_FAILURE;
+        }
+        settings.server = NULL;
+    } else if (settings.watch) {
+        if (argc != 3 || !fileisdir(argv[1]))
+            fail("--watch requires a SOURCE directory and a DEST");
+        if (settings.filesfrom || settings.shardcount || settings.dedup
+                               || settings.journal)
+            fail("--watch cannot be used with --files-from, --shard,"
+                 " --dedup, or --journal");
+        exitcode = EXIT_SUCCESS;
+        if (!runwatch(argv[1], argv[2], watchfile, cfg.ppp)) {
+            perror(argv[1]);
+            exitcode = EXIT_FAILURE;
+        }
+    } else {
+        if (settings.perfcounters) {
+            if (settings.jobs > 1)
+                fail("--perf-counters cannot be used with --jobs");
+            if (!startperfcounters()) {
+                fprintf(stderr, "performance counters unavailable: %s\n",
+                                strerror(errno));
+                settings.perfcounters = FALSE;
+            }
+        }
+        if (settings.journal) {
+            if (settings.check || settings.deps || settings.buildindex
+                               || settings.edits || settings.variants
+                               || settings.tarin || settings.tarout)
+                fail("--journal cannot be used with --check, --deps,"
+                     " --build-index, --emit-edits, --variants, or --tar-in");
+            if (!(completed = openjournal(settings.journal))) {
+                if (errno)
+                    perror(settings.journal);
+                else
+                    fprintf(stderr, "%s: not a journal file\n",
+                                    settings.journal);
+                return EXIT_FAILURE;
+            }
+        }
+        exitcode = processfiles(&cfg, argc, argv);
+        if (completed && !closejournal(completed)) {
+            perror(settings.journal);
+            exitcode = EXIT_FAILURE;
+        }
+        completed = NULL;
+        if (settings.perfcounters) {
+            stopperfcounters();
+            showperfcounters();
+        }
+    }
+
+    freeppproc(cfg.ppp);
+    freesymset(cfg.defs);
+    freesymset(cfg.undefs);
+    deallocate(settings.variants);
+    if (settings.stats)
+        showstats();
     return exitcode;
 }
@@ -0,0 +1,264 @@
+/* cppp.hpp: Copyright (C) 2022 by Brian Raiter <breadbox@muppetlabs.com>
+ * License GPLv2+: GNU GPL version 2 or later.
+ */
+#ifndef _cppp_hpp_
+#define _cppp_hpp_
+
+/*
+ * A C++17 interface to the partial preprocessor, for programs that
+ * link with libcppp.a. The classes own the underlying symset and
+ * ppproc objects, and inputs are taken as string views. The output of
+ * a file is a range of chunks: runs of lines copied unaltered from
+ * the input are views into the input itself, and only the text that
+ * was changed is stored separately. Note that errors are still
+ * reported on stderr, and the library is not thread-safe.
+ */
+
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+extern "C" {
+#include "gen.h"
+#include "types.h"
+#include "error.h"
+#include "symset.h"
+#include "ppproc.h"
+}
+
+namespace cppp {
+
+/* A set of symbols, each with an integer value. The names are copied
+ * and kept for as long as the set exists.
+ */
+class symbols {
+  public:
+    symbols() : set(initsymset()) { }
+    symbols(symbols &&other) noexcept
+        : set(std::exchange(other.set, nullptr)),
+          names(std::move(other.names)) { }
+    symbols(symbols const &) = delete;
+    symbols &operator=(symbols const &) = delete;
+    ~symbols() { if (set) freesymset(set); }
+
+    /* Adds a symbol to the set, replacing any earlier value.
+     */
+    void add(std::string_view id, long value = 1) {
+        remove(id);
+        names.emplace_back(id);
+        addsymboltoset(set, names.back().c_str(), value);
+    }
+
+    /* Removes a symbol from the set. The return value is false if the
+     * symbol was not in the set.
+     */
+    bool remove(std::string_view id) {
+        std::string name(id);
+        return removesymbolfromset(set, name.c_str());
+    }
+
+    /* Returns true if the symbol is in the set. If value is not null,
+     * it receives the symbol's value.
+     */
+    bool contains(std::string_view id, long *value = nullptr) const {
+        std::string name(id);
+        return findsymbolinset(set, name.c_str(), value);
+    }
+
+    symset const *get() const { return set; }
+
+  private:
+    symset *set;
+    std::deque<std::string> names;
+};
+
+/* The output produced for one input: a sequence of string views. A
+ * chunk that lies within the input remains valid only as long as the
+ * input does; every other chunk is owned by this object.
+ */
+class output {
+  public:
+    typedef std::vector<std::string_view>::const_iterator const_iterator;
+
+    output() = default;
+    output(output &&) = default;
+    output &operator=(output &&) = default;
+    output(output const &) = delete;
+    output &operator=(output const &) = delete;
+
+    const_iterator begin() const { return chunks.begin(); }
+    const_iterator end() const { return chunks.end(); }
+    std::size_t size() const { return chunks.size(); }
+    bool empty() const { return chunks.empty(); }
+
+    /* Returns the complete output as a single string.
+     */
+    std::string str() const {
+        std::string s;
+        std::size_t n = 0;
+        for (auto const &c : chunks)
+            n += c.size();
+        s.reserve(n);
+        for (auto const &c : chunks)
+            s.append(c);
+        return s;
+    }
+
+    /* Adds text to the end of the output. Text lying within the input
+     * is referred to directly, and is merged with the preceding chunk
+     * when the two are adjacent; anything else is copied.
+     */
+    void append(std::string_view input, char const *text, std::size_t n) {
+        std::less_equal<char const*> le;
+        if (le(input.data(), text)
+                    && le(text + n, input.data() + input.size())) {
+            if (!chunks.empty() && lastininput
+                                && chunks.back().data() + chunks.back().size()
+                                        == text)
+                chunks.back() = std::string_view(chunks.back().data(),
+                                                 chunks.back().size() + n);
+            else
+                chunks.emplace_back(text, n);
+            lastininput = true;
+        } else {
+            owned.emplace_back(text, n);
+            chunks.emplace_back(owned.back());
+            lastininput = false;
+        }
+    }
+
+  private:
+    std::vector<std::string_view> chunks;
+    std::deque<std::string> owned;
+    bool lastininput = false;
+};
+
+/* A partial preprocessor using a given pair of symbol sets, which
+ * must outlive it.
+ */
+class preprocessor {
+  public:
+    preprocessor(symbols const &defs, symbols const &undefs)
+        : ppp(initppproc(defs.get(), undefs.get())) { }
+    preprocessor(preprocessor &&other) noexcept
+        : ppp(std::exchange(other.ppp, nullptr)),
+          feeding(std::move(other.feeding)) { }
+    preprocessor(preprocessor const &) = delete;
+    preprocessor &operator=(preprocessor const &) = delete;
+    ~preprocessor() { if (ppp) freeppproc(ppp); }
+
+    /* Selects between producing the processed source and producing a
+     * unified diff of the changes.
+     */
+    void edits(bool flag) { outputedits(ppp, flag); }
+
+    /* Partially preprocesses input, passing each run of output text
+     * to fn as a std::string_view. Runs copied unaltered are views
+     * into input; anything else is only valid during the call. An
+     * exception thrown by fn stops the output and is rethrown. The
+     * return value is false if any errors were found in the input.
+     */
+    template<typename F>
+    bool process(std::string_view input, F &&fn,
+                 char const *filename = nullptr) {
+        sinkcall<F> call{ fn, nullptr };
+        int mark = geterrormark();
+        partialpreprocessbuffer(ppp, input.data(), input.size(),
+                                &sinkcall<F>::sink, &call, filename);
+        if (call.thrown)
+            std::rethrow_exception(call.thrown);
+        return !errorsincemark(mark);
+    }
+
+    /* Partially preprocesses input, returning the output as a range
+     * of chunks. If ok is not null, it is set to false if any errors
+     * were found in the input.
+     */
+    output process(std::string_view input, char const *filename = nullptr,
+                   bool *ok = nullptr) {
+        output out;
+        bool r = process(input, [&](std::string_view text) {
+            out.append(input, text.data(), text.size());
+        }, filename);
+        if (ok)
+            *ok = r;
+        return out;
+    }
+
+    /* Begins partially preprocessing an input that is supplied in
+     * pieces, such as from an event loop. Each run of output text is
+     * passed to fn, which is kept until finish() is called. The text
+     * is only valid during the call.
+     */
+    void begin(std::function<void(std::string_view)> fn,
+               char const *filename = nullptr) {
+        feeding = std::make_unique<feedstate>(std::move(fn));
+        feeding->mark = geterrormark();
+        beginfeed(ppp, &sinkcall<outputfn>::sink, &feeding->call, filename);
+    }
+
+    /* Supplies the next piece of the input. Only an incomplete line at
+     * the end of a piece is held back. An exception thrown by the
+     * output function is rethrown here.
+     */
+    void feed(std::string_view piece) {
+        feedpreprocess(ppp, piece.data(), piece.size());
+        if (feeding->call.thrown)
+            std::rethrow_exception(feeding->call.thrown);
+    }
+
+    /* Finishes the input begun by begin(). The return value is false
+     * if any errors were reported since it began.
+     */
+    bool finish() {
+        std::unique_ptr<feedstate> f = std::move(feeding);
+        finishpreprocess(ppp);
+        if (f->call.thrown)
+            std::rethrow_exception(f->call.thrown);
+        return !errorsincemark(f->mark);
+    }
+
+    ppproc *get() { return ppp; }
+
+  private:
+    template<typename F>
+    struct sinkcall {
+        F &fn;
+        std::exception_ptr thrown;
+
+        static int sink(char const *text, std::size_t size, void *data) {
+            sinkcall *call = static_cast<sinkcall*>(data);
+            if (call->thrown)
+                return 0;
+            try {
+                call->fn(std::string_view(text, size));
+            } catch (...) {
+                call->thrown = std::current_exception();
+                return 0;
+            }
+            return 1;
+        }
+    };
+
+    typedef std::function<void(std::string_view)> outputfn;
+
+    struct feedstate {
+        explicit feedstate(outputfn f) : fn(std::move(f)) { }
+        outputfn fn;
+        sinkcall<outputfn> call{ fn, nullptr };
+        int mark = 0;
+    };
+
+    ppproc *ppp;
+    std::unique_ptr<feedstate> feeding;
+};
+
+}
+
+#endif
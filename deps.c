@@ -0,0 +1,194 @@
+/* deps.c: Copyright (C) 2022 by Brian Raiter <breadbox@muppetlabs.com>
+ * License GPLv2+: GNU GPL version 2 or later.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#define MEMTAG memDeps
+#include "gen.h"
+#include "types.h"
+#include "deps.h"
+
+/*
+ * Rather than maintaining a map in each direction, the index is kept
+ * as a flat list of references, each pairing a symbol with a file.
+ * The list is sorted once by file and once by symbol when the index
+ * is written out.
+ */
+
+typedef struct depref depref;
+
+/* A single reference to a symbol by a file.
+ */
+struct depref {
+    char       *symbol;         /* the symbol's name */
+    int         file;           /* the file's position in the list */
+};
+
+/* The dependency index.
+ */
+struct depindex {
+    char      **files;          /* the names of the files */
+    int         filecount;      /* how many files have been added */
+    int         filesallocated; /* the size of the files array */
+    depref     *refs;           /* all of the symbol references */
+    int         refcount;       /* how many references have been added */
+    int         refsallocated;  /* the size of the refs array */
+    int         firstref;       /* the first reference of the current file */
+};
+
+/* Creates an empty dependency index.
+ */
+depindex *initdepindex(void)
+{
+    depindex *deps;
+
+    deps = allocate(sizeof *deps);
+    deps->files = NULL;
+    deps->filecount = 0;
+    deps->filesallocated = 0;
+    deps->refs = NULL;
+    deps->refcount = 0;
+    deps->refsallocated = 0;
+    deps->firstref = 0;
+    return deps;
+}
+
+/* Deallocates the dependency index.
+ */
+void freedepindex(depindex *deps)
+{
+    int i;
+
+    for (i = 0 ; i < deps->filecount ; ++i)
+        deallocate(deps->files[i]);
+    for (i = 0 ; i < deps->refcount ; ++i)
+        deallocate(deps->refs[i].symbol);
+    deallocate(deps->files);
+    deallocate(deps->refs);
+    deallocate(deps);
+}
+
+/* Adds a file to the list.
+ */
+void adddepfile(depindex *deps, char const *filename)
+{
+    if (deps->filecount == deps->filesallocated) {
+        deps->filesallocated = deps->filesallocated ?
+                                        2 * deps->filesallocated : 16;
+        deps->files = reallocate(deps->files,
+                                 deps->filesallocated * sizeof *deps->files);
+    }
+    deps->files[deps->filecount] = allocate(strlen(filename) + 1);
+    strcpy(deps->files[deps->filecount], filename);
+    ++deps->filecount;
+    deps->firstref = deps->refcount;
+}
+
+/* Adds a reference from the current file to a symbol, unless the file
+ * already refers to it.
+ */
+void adddepsymbol(depindex *deps, char const *id)
+{
+    char *symbol;
+    int size, i;
+
+    if (!deps->filecount)
+        return;
+    for (size = 0 ; _issym(id[size]) ; ++size) ;
+    for (i = deps->firstref ; i < deps->refcount ; ++i)
+        if (!memcmp(deps->refs[i].symbol, id, size)
+                        && !deps->refs[i].symbol[size])
+            return;
+    symbol = allocate(size + 1);
+    memcpy(symbol, id, size);
+    symbol[size] = '\0';
+    if (deps->refcount == deps->refsallocated) {
+        deps->refsallocated = deps->refsallocated ?
+                                        2 * deps->refsallocated : 64;
+        deps->refs = reallocate(deps->refs,
+                                deps->refsallocated * sizeof *deps->refs);
+    }
+    deps->refs[deps->refcount].symbol = symbol;
+    deps->refs[deps->refcount].file = deps->filecount - 1;
+    ++deps->refcount;
+}
+
+/* The file names, for comparing references by file.
+ */
+static char **sortfiles;
+
+/* Orders references by filename, and then by symbol.
+ */
+static int cmpbyfile(void const *a, void const *b)
+{
+    depref const *ra = a;
+    depref const *rb = b;
+    int n;
+
+    n = strcmp(sortfiles[ra->file], sortfiles[rb->file]);
+    if (!n)
+        n = ra->file - rb->file;
+    return n ? n : strcmp(ra->symbol, rb->symbol);
+}
+
+/* Orders references by symbol, and then by filename.
+ */
+static int cmpbysymbol(void const *a, void const *b)
+{
+    depref const *ra = a;
+    depref const *rb = b;
+    int n;
+
+    n = strcmp(ra->symbol, rb->symbol);
+    if (!n)
+        n = strcmp(sortfiles[ra->file], sortfiles[rb->file]);
+    return n ? n : ra->file - rb->file;
+}
+
+/* Writes out the index in both directions. Files are renumbered in
+ * order of their names, omitting the files that reference nothing.
+ */
+int writedepindex(depindex *deps, FILE *outfile)
+{
+    int *number;
+    int count, i;
+
+    sortfiles = deps->files;
+    qsort(deps->refs, deps->refcount, sizeof *deps->refs, cmpbyfile);
+    number = allocate((deps->filecount + 1) * sizeof *number);
+    count = 0;
+    for (i = 0 ; i < deps->refcount ; ++i) {
+        if (!i || deps->refs[i].file != deps->refs[i - 1].file) {
+            if (i)
+                fputc('\n', outfile);
+            number[deps->refs[i].file] = count;
+            fprintf(outfile, "file\t%d\t%s\t", count,
+                    deps->files[deps->refs[i].file]);
+            ++count;
+        } else {
+            fputc(' ', outfile);
+        }
+        fputs(deps->refs[i].symbol, outfile);
+    }
+    if (deps->refcount)
+        fputc('\n', outfile);
+
+    qsort(deps->refs, deps->refcount, sizeof *deps->refs, cmpbysymbol);
+    for (i = 0 ; i < deps->refcount ; ++i) {
+        if (!i || strcmp(deps->refs[i].symbol, deps->refs[i - 1].symbol)) {
+            if (i)
+                fputc('\n', outfile);
+            fprintf(outfile, "symbol\t%s\t", deps->refs[i].symbol);
+        } else {
+            fputc(' ', outfile);
+        }
+        fprintf(outfile, "%d", number[deps->refs[i].file]);
+    }
+    if (deps->refcount)
+        fputc('\n', outfile);
+
+    deallocate(number);
+    return !ferror(outfile);
+}
@@ -0,0 +1,51 @@
+/* deps.h: Copyright (C) 2022 by Brian Raiter <breadbox@muppetlabs.com>
+ * License GPLv2+: GNU GPL version 2 or later.
+ */
+#ifndef _deps_h_
+#define _deps_h_
+
+/*
+ * A depindex object records which preprocessor symbols are tested by
+ * the conditional statements of each file in a collection, and
+ * outputs both that mapping and its inverse, listing the files that
+ * test each symbol.
+ */
+
+#include <stdio.h>
+#include "types.h"
+
+/* Creates an empty dependency index.
+ */
+extern depindex *initdepindex(void);
+
+/* Deallocates the dependency index.
+ */
+extern void freedepindex(depindex *deps);
+
+/* Begins recording the symbols for another file. The filename is
+ * copied.
+ */
+extern void adddepfile(depindex *deps, char const *filename);
+
+/* Records that the current file tests the symbol whose name appears
+ * at id. The name is typically embedded within a larger string, and
+ * is copied. Duplicates are ignored.
+ */
+extern void adddepsymbol(depindex *deps, char const *id);
+
+/* Writes the index to outfile. Each file that tests at least one
+ * symbol is given a number and listed on a line of the form:
+ *
+ *     file <TAB> number <TAB> filename <TAB> symbol symbol ...
+ *
+ * after which each symbol is listed with the numbers of the files
+ * that test it:
+ *
+ *     symbol <TAB> name <TAB> number number ...
+ *
+ * Both lists are sorted. The return value is false if an error
+ * occurs.
+ */
+extern int writedepindex(depindex *deps, FILE *outfile);
+
+#endif
@@ -14,6 +14,7 @@ struct errhandler {
     unsigned long   lineno;     /* a line number to accompany the filename */
     int             count;      /* total number of errors seen */
     enum errortype  type;       /* the most recent error */
+    int             muted;      /* true if messages are not displayed */
 };
 
 /* There is only one error handler for the program.
@@ -43,6 +44,20 @@ void nexterrorline(void)
     ++err.lineno;
 }
 
+/* Returns the file's current line number.
+ */
+unsigned long geterrorline(void)
+{
+    return err.lineno;
+}
+
+/* Suppresses or restores the display of error messages.
+ */
+void muteerrors(int flag)
+{
+    err.muted = flag;
+}
+
 /* Returns the current error count.
  */
 int geterrormark(void)
@@ -67,6 +82,8 @@ void error(enum errortype type)
     if (type == errNone)
         return;
     ++err.count;
+    if (err.muted)
+        return;
 
     if (err.file) {
         if (err.lineno)
@@ -90,9 +107,6 @@ void error(enum errortype type)
         else
             fputs("file I/O error.", stderr);
         break;
-      case errIfsTooDeep:
-        fputs("too many nested #ifs.", stderr);
-        break;
       case errDanglingElse:
         fputs("#else not matched to any #if.", stderr);
         break;
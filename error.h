@@ -26,7 +26,6 @@ enum errortype
     errOpenIf,                  /* unclosed #if */
     errElifWithIfdef,           /* #elif following #ifdef/#ifndef */
     errElifdefWithIf,           /* #elifdef/#elifndef following #if */
-    errIfsTooDeep,              /* way too many nested #ifs */
     errOpenParenthesis,         /* unclosed left parenthesis */
     errMissingOperand,          /* operand expected to follow expression */
     errZeroDiv,                 /* division by zero in an expression */
@@ -53,6 +52,17 @@ extern void seterrorline(unsigned long lineno);
  */
 extern void nexterrorline(void);
 
+/* Returns the current line number, so that it can be restored later
+ * with seterrorline().
+ */
+extern unsigned long geterrorline(void);
+
+/* Suppresses the display of error messages if flag is true, or
+ * restores it if flag is false. Errors are still counted while
+ * messages are suppressed.
+ */
+extern void muteerrors(int flag);
+
 /* Returns the number of errors that have occurred so far.
  */
 extern int geterrormark(void);
@@ -7,6 +7,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#define MEMTAG memExptree
 #include "gen.h"
 #include "types.h"
 #include "error.h"
@@ -43,9 +44,12 @@ enum op
     opCount
 };
 
-/* The representation of a parsed expresssion tree.
+/* One instruction of a compiled expression. An expression is
+ * compiled to a flat array of instructions in postfix order, so that
+ * each instruction follows the instructions of its subexpressions.
+ * Each one records the span of source code that it was parsed from.
  */
-struct exptree {
+typedef struct expcode {
     char const *begin;          /* start of the expression in the source */
     char const *end;            /* end of the expression */
     int         valued;         /* true if it has a definite value */
@@ -53,8 +57,43 @@ struct exptree {
     enum exp    exp;            /* the type of expression */
     enum op     op;             /* the operator for this expression, if any */
     char const *identifier;     /* the identifer, for the defined operator */
+    int         parent;         /* the enclosing expression, or -1 if none */
     int         childcount;     /* how many subexpressions are present */
-    exptree    *child[4];       /* pointers to the subexpressions */
+    int         child[3];       /* the indexes of the subexpressions */
+} expcode;
+
+/* The kinds of pending constructs on the parser's stack.
+ */
+enum frame
+{
+    frameParen,                 /* awaiting a right parenthesis */
+    framePrefix,                /* awaiting the operand of a prefix operator */
+    frameInfix,                 /* awaiting the right operand of an operator */
+    frameCondition,             /* awaiting the colon of a ?: operator */
+    frameAlternative            /* awaiting the last operand of a ?: */
+};
+
+/* An entry on the parser's stack, which takes the place of recursion
+ * so that deeply nested expressions can be parsed.
+ */
+typedef struct expframe {
+    enum frame  kind;           /* what is being awaited */
+    struct opinfo const *info;  /* the operator, if any */
+    char const *begin;          /* the start of the construct */
+    int         prec;           /* the precedence to return to afterwards */
+    int         child[3];       /* the operands parsed so far */
+} expframe;
+
+/* The representation of a parsed expression.
+ */
+struct exptree {
+    expcode    *code;           /* the compiled expression */
+    int         count;          /* how many instructions are present */
+    int         allocated;      /* the allocated size of the code array */
+    int         root;           /* the complete expression, or -1 if none */
+    expframe   *stack;          /* the stack used while parsing */
+    int         depth;          /* the number of entries on the stack */
+    int         stackallocated; /* the allocated size of the stack */
 };
 
 /*
@@ -106,11 +145,13 @@ exptree *initexptree(void)
     exptree *t;
 
     t = allocate(sizeof *t);
-    t->childcount = 0;
-    t->exp = expNone;
-    t->valued = FALSE;
-    t->begin = NULL;
-    t->end = NULL;
+    t->code = NULL;
+    t->count = 0;
+    t->allocated = 0;
+    t->root = -1;
+    t->stack = NULL;
+    t->depth = 0;
+    t->stackallocated = 0;
     return t;
 }
 
@@ -118,69 +159,114 @@ exptree *initexptree(void)
  */
 void freeexptree(exptree *t)
 {
-    int n;
-
     if (t) {
-        for (n = 0 ; n < t->childcount ; ++n)
-            freeexptree(t->child[n]);
+        deallocate(t->code);
+        deallocate(t->stack);
         deallocate(t);
     }
 }
 
-/* Resets an expression tree to be empty.
+/* Resets an expression tree to be empty. The allocated memory is
+ * retained for the next expression.
  */
 void clearexptree(exptree *t)
 {
-    t->childcount = 0;
-    t->exp = expNone;
-    t->valued = FALSE;
-    t->begin = NULL;
-    t->end = NULL;
+    t->count = 0;
+    t->root = -1;
+    t->depth = 0;
 }
 
 /* Returns the length of the C source representing the expression.
  */
 int getexplength(exptree const *t)
 {
-    return t->exp == expNone ? 0 : (int)(t->end - t->begin);
+    if (t->root < 0)
+        return 0;
+    return (int)(t->code[t->root].end - t->code[t->root].begin);
 }
 
-/* Inserts a subtree into the given expression tree, with pos being
- * the index of where to add the child branch.
+/* Returns the number of instructions in the compiled expression.
  */
-static int addchild(exptree *t, exptree *sub, int pos)
+int getexpnodecount(exptree const *t)
 {
-    int n;
+    return t->count;
+}
 
-    if (t->childcount == sizearray(t->child) || !sub)
-        return FALSE;
-    if (pos < -1 || pos > t->childcount)
-        return FALSE;
+/* Appends a new instruction to the compiled expression, and returns
+ * its index.
+ */
+static int addcode(exptree *t, enum exp exp, char const *begin)
+{
+    expcode *x;
 
-    if (pos == -1 || pos == t->childcount) {
-        t->child[t->childcount] = sub;
-    } else {
-        for (n = t->childcount ; n > pos ; --n)
-            t->child[n] = t->child[n - 1];
-        t->child[pos] = sub;
+    if (t->count == t->allocated) {
+        t->allocated = t->allocated ? 2 * t->allocated : 16;
+        t->code = reallocate(t->code, t->allocated * sizeof *t->code);
     }
-    ++t->childcount;
-    return TRUE;
+    x = &t->code[t->count];
+    x->begin = begin;
+    x->end = begin;
+    x->valued = FALSE;
+    x->value = 0;
+    x->exp = exp;
+    x->op = opNone;
+    x->identifier = NULL;
+    x->parent = -1;
+    x->childcount = 0;
+    return t->count++;
 }
 
-/* Creates and returns a new subtree, with pos being the index of
- * which child branch to insert the new subtree at.
+/* Appends an operator instruction that applies to the given
+ * subexpressions, and returns its index.
  */
-static exptree *addnewchild(exptree *t, int pos)
+static int addoperator(exptree *t, enum op op, char const *begin,
+                       int const *child, int childcount)
 {
-    exptree *child;
+    int n, i;
+
+    n = addcode(t, expOperator, begin);
+    t->code[n].op = op;
+    t->code[n].end = t->code[child[childcount - 1]].end;
+    t->code[n].childcount = childcount;
+    for (i = 0 ; i < childcount ; ++i) {
+        t->code[n].child[i] = child[i];
+        t->code[child[i]].parent = n;
+    }
+    return n;
+}
 
-    child = initexptree();
-    if (!addchild(t, child, pos)) {
-        deallocate(child);
-        return NULL;
+/* Pushes a new entry onto the parser's stack and returns it.
+ */
+static expframe *pushframe(exptree *t, enum frame kind,
+                           struct opinfo const *info, char const *begin,
+                           int prec)
+{
+    expframe *f;
+
+    if (t->depth == t->stackallocated) {
+        t->stackallocated = t->stackallocated ? 2 * t->stackallocated : 16;
+        t->stack = reallocate(t->stack, t->stackallocated * sizeof *t->stack);
     }
-    return child;
+    f = &t->stack[t->depth++];
+    f->kind = kind;
+    f->info = info;
+    f->begin = begin;
+    f->prec = prec;
+    return f;
+}
+
+/* Returns the entry in the given operator table that appears at
+ * input, or NULL if none do.
+ */
+static struct opinfo const *findop(struct opinfo const *ops, int count,
+                                   char const *input)
+{
+    int n;
+
+    for (n = 0 ; n < count ; ++n)
+        if (!memcmp(input, ops[n].symbol, ops[n].size))
+            return &ops[n];
+    return NULL;
 }
 
 /* Returns the value of the character literal pointed to by input.
@@ -279,29 +365,33 @@ static int getmcharconstant(char const *input, char const *end)
 }
 
 /* Reads a constant from the C source at input via the given lexer,
- * and uses it to initialize the expression tree. Literal numbers,
+ * and appends it to the compiled expression. Literal numbers,
  * strings, characters, macro identifiers and function-like macro
  * invocations, and uses of the defined operator are all considered
- * constants by this function. The return value is the text following
- * the constant.
+ * constants by this function. index receives the index of the new
+ * instruction, or -1 if no valid constant was present. The return
+ * value is the text following the constant.
  */
-static char const *parseconstant(exptree *t, clexer *cl, char const *input)
+static char const *parseconstant(exptree *t, clexer *cl, char const *input,
+                                 int *index)
 {
+    expcode *x;
     char *p;
     int size, paren, mark;
 
     mark = geterrormark();
-    t->begin = input;
+    *index = addcode(t, expNone, input);
+    x = &t->code[*index];
     if (charquotep(cl)) {
-        t->exp = expConstant;
-        t->valued = TRUE;
+        x->exp = expConstant;
+        x->valued = TRUE;
         while (!endoflinep(cl) && charquotep(cl))
             input = nextchar(cl, input);
-        t->end = input;
-        t->value = getmcharconstant(t->begin + 1, t->end - 1);
+        x->end = input;
+        x->value = getmcharconstant(x->begin + 1, x->end - 1);
         input = skipwhite(cl, input);
     } else if (!memcmp(input, "defined", 7)) {
-        t->exp = expDefined;
+        x->exp = expDefined;
         input = skipwhite(cl, nextchars(cl, input, 7));
         paren = *input == '(';
         if (paren)
@@ -311,7 +401,7 @@ static char const *parseconstant(exptree *t, clexer *cl, char const *input)
             error(errDefinedSyntax);
             goto failure;
         }
-        t->identifier = input;
+        x->identifier = input;
         input = nextchars(cl, input, size);
         if (paren) {
             input = skipwhite(cl, input);
@@ -321,11 +411,11 @@ static char const *parseconstant(exptree *t, clexer *cl, char const *input)
             }
             input = nextchar(cl, input);
         }
-        t->valued = FALSE;
-        t->end = input;
+        x->valued = FALSE;
+        x->end = input;
         input = skipwhite(cl, input);
     } else if (isdigit(*input)) {
-        t->exp = expConstant;
+        x->exp = expConstant;
         if (*input == '0') {
             input = nextchar(cl, input);
             if (tolower(*input) == 'x') {
@@ -341,8 +431,8 @@ static char const *parseconstant(exptree *t, clexer *cl, char const *input)
                 input = nextchar(cl, input);
             while (isdigit(*input));
         }
-        t->value = strtol(t->begin, &p, 0);
-        t->valued = p == input;
+        x->value = strtol(x->begin, &p, 0);
+        x->valued = p == input;
         if (toupper(*input) == 'L') {
             input = nextchar(cl, input);
             if (toupper(*input) == 'L')
@@ -357,16 +447,16 @@ static char const *parseconstant(exptree *t, clexer *cl, char const *input)
                     input = nextchar(cl, input);
             }
         }
-        t->end = input;
+        x->end = input;
         input = skipwhite(cl, input);
     } else if (_issym(*input)) {
         do
             input = nextchar(cl, input);
         while (_issym(*input));
-        t->end = input;
+        x->end = input;
         input = skipwhite(cl, input);
         if (*input == '(') {
-            t->exp = expParamMacro;
+            x->exp = expParamMacro;
             paren = getparenlevel(cl);
             do {
                 input = nextchar(cl, input);
@@ -375,11 +465,11 @@ static char const *parseconstant(exptree *t, clexer *cl, char const *input)
                     goto failure;
                 }
             } while (getparenlevel(cl) >= paren);
-            t->valued = FALSE;
-            t->end = input;
+            x->valued = FALSE;
+            x->end = input;
             input = skipwhite(cl, input);
         } else {
-            t->exp = expMacro;
+            x->exp = expMacro;
         }
     } else {
         error(errSyntax);
@@ -390,123 +480,104 @@ static char const *parseconstant(exptree *t, clexer *cl, char const *input)
         return input;
 
   failure:
-    t->exp = expNone;
-    t->end = input;
+    --t->count;
+    *index = -1;
     return input;
 }
 
 /* Parses a C preprocessor expression from the C source code pointed
- * to by input, via the given lexer, and creates a expression tree
- * representing it. prec gives the precedence of the operator this
- * expression is attached to, or zero if there is no such operator.
- * The return value points to the source immediately following the
- * parsed expression.
+ * to by input, via the given lexer, and compiles it into the
+ * expression tree. This is a precedence-climbing parser that uses an
+ * explicit stack in place of recursion: prec gives the precedence of
+ * the operator the current operand is attached to, or zero if there
+ * is no such operator, and the stack holds the constructs that are
+ * still waiting for an operand to be completed. The return value
+ * points to the source immediately following the parsed expression.
  */
-static char const *parseexp(exptree *t, clexer *cl, char const *input,
-                            int prec)
+static char const *parseexp(exptree *t, clexer *cl, char const *input)
 {
-    exptree *x;
-    char const *tmp;
-    int found, n;
+    struct opinfo const *info;
+    expframe *f;
+    int top, prec;
 
-    if (t->exp != expNone)
-        return input;
+    prec = 0;
 
-    if (*input == '(') {
-        tmp = input;
-        input = skipwhite(cl, nextchar(cl, input));
-        input = parseexp(t, cl, input, 0);
-        if (t->exp == expNone) {
-            error(errSyntax);
-            goto failure;
-        } else if (*input != ')') {
-            error(errOpenParenthesis);
-            goto failure;
-        }
-        t->begin = tmp;
-        input = nextchar(cl, input);
-        t->end = input;
-        input = skipwhite(cl, input);
-    } else {
-        found = FALSE;
-        for (n = 0 ; n < sizearray(prefixops) ; ++n) {
-            if (!memcmp(input, prefixops[n].symbol, prefixops[n].size)) {
-                found = TRUE;
-                break;
-            }
-        }
-        if (found) {
-            if (prefixops[n].prec < prec) {
-                error(errMissingOperand);
-                goto failure;
-            }
-            t->exp = expOperator;
-            t->op = prefixops[n].op;
-            t->begin = input;
-            input = nextchars(cl, input, prefixops[n].size);
+  operand:
+    for (;;) {
+        if (*input == '(') {
+            pushframe(t, frameParen, NULL, input, prec);
+            input = skipwhite(cl, nextchar(cl, input));
+            prec = 0;
+        } else if ((info = findop(prefixops, sizearray(prefixops), input))) {
+            pushframe(t, framePrefix, info, input, prec);
+            input = nextchars(cl, input, info->size);
             input = skipwhite(cl, input);
-            x = addnewchild(t, -1);
-            input = parseexp(x, cl, input, prefixops[n].prec);
-            if (x->exp == expNone) {
-                error(errSyntax);
-                goto failure;
-            }
-            t->end = x->end;
+            prec = info->prec;
         } else {
-            input = parseconstant(t, cl, input);
-            if (t->exp == expNone) {
-                error(errSyntax);
-                goto failure;
-            }
+            break;
         }
     }
+    input = parseconstant(t, cl, input, &top);
+    if (top < 0)
+        goto failure;
 
     for (;;) {
-        found = FALSE;
-        for (n = 0 ; n < sizearray(infixops) ; ++n) {
-            if (!memcmp(input, infixops[n].symbol, infixops[n].size)) {
-                found = TRUE;
-                break;
-            }
+        info = findop(infixops, sizearray(infixops), input);
+        if (info && (info->prec > prec || (info->prec == prec && !info->l2r))) {
+            f = pushframe(t, info->op == opConditional ? frameCondition
+                                                       : frameInfix,
+                          info, t->code[top].begin, prec);
+            f->child[0] = top;
+            input = nextchars(cl, input, info->size);
+            input = skipwhite(cl, input);
+            prec = info->prec;
+            goto operand;
         }
-        if (!found || infixops[n].prec < prec
-                   || (infixops[n].prec == prec && infixops[n].l2r))
+        if (!t->depth)
             break;
-        input = nextchars(cl, input, infixops[n].size);
-        input = skipwhite(cl, input);
-        x = initexptree();
-        tmp = t->begin;
-        *x = *t;
-        clearexptree(t);
-        t->exp = expOperator;
-        t->op = infixops[n].op;
-        t->begin = tmp;
-        addchild(t, x, -1);
-        x = addnewchild(t, -1);
-        if (t->op == opConditional) {
-            input = parseexp(x, cl, input, infixops[n].prec);
-            if (x->exp == expNone) {
-                error(errSyntax);
+        f = &t->stack[--t->depth];
+        switch (f->kind) {
+          case frameParen:
+            if (*input != ')') {
+                error(errOpenParenthesis);
                 goto failure;
             }
+            input = nextchar(cl, input);
+            t->code[top].begin = f->begin;
+            t->code[top].end = input;
+            input = skipwhite(cl, input);
+            break;
+          case framePrefix:
+            top = addoperator(t, f->info->op, f->begin, &top, 1);
+            break;
+          case frameInfix:
+            f->child[1] = top;
+            top = addoperator(t, f->info->op, f->begin, f->child, 2);
+            break;
+          case frameCondition:
             if (*input != ':') {
                 error(errSyntax);
                 goto failure;
             }
             input = skipwhite(cl, nextchar(cl, input));
-            x = addnewchild(t, -1);
-        }
-        input = parseexp(x, cl, input, infixops[n].prec);
-        if (x->exp == expNone) {
-            error(errSyntax);
-            goto failure;
+            f->kind = frameAlternative;
+            f->child[1] = top;
+            ++t->depth;
+            prec = f->info->prec;
+            goto operand;
+          case frameAlternative:
+            f->child[2] = top;
+            top = addoperator(t, f->info->op, f->begin, f->child, 3);
+            break;
         }
-        t->end = x->end;
+        prec = f->prec;
     }
+    t->root = top;
     return input;
 
   failure:
-    t->exp = expNone;
+    t->root = -1;
+    t->depth = 0;
     return input;
 }
 
@@ -514,33 +585,35 @@ static char const *parseexp(exptree *t, clexer *cl, char const *input,
  */
 char const *parseexptree(exptree *t, clexer *cl, char const *input)
 {
-    return parseexp(t, cl, input, 0);
+    clearexptree(t);
+    return parseexp(t, cl, input);
 }
 
-/* Recursively examines an expression tree and sets the definition
- * state of any identifiers within that appear in the given symset.
- * The third parameter indicates whether the identifiers are to be
- * treated as defined or as undefined.
+/* Sweeps through the compiled expression and sets the definition
+ * state of any identifiers within that appear in either symset.
  */
-int markdefined(exptree *t, symset const *set, int defined)
+int markdefined(exptree *t, symset const *defs, symset const *undefs)
 {
+    expcode *x;
     long value;
-    int count, n;
+    int count, n, r;
 
     count = 0;
-    for (n = 0 ; n < t->childcount ; ++n)
-        count += markdefined(t->child[n], set, defined);
-    if (!t->valued) {
-        if (t->exp == expDefined) {
-            if (findsymbolinset(set, t->identifier, NULL)) {
-                t->valued = TRUE;
-                t->value = defined ? 1 : 0;
+    for (n = 0 ; n < t->count ; ++n) {
+        x = &t->code[n];
+        if (x->valued)
+            continue;
+        if (x->exp == expDefined) {
+            r = resolvesymbol(defs, undefs, x->identifier, NULL);
+            if (r) {
+                x->valued = TRUE;
+                x->value = r > 0 ? 1 : 0;
                 ++count;
             }
-        } else if (t->exp == expMacro) {
-            if (findsymbolinset(set, t->begin, &value)) {
-                t->valued = TRUE;
-                t->value = defined ? value : 0;
+        } else if (x->exp == expMacro) {
+            if (resolvesymbol(defs, undefs, x->begin, &value)) {
+                x->valued = TRUE;
+                x->value = value;
                 ++count;
             }
         }
@@ -548,89 +621,95 @@ int markdefined(exptree *t, symset const *set, int defined)
     return count;
 }
 
-/* Calculates the value of the parsed C preprocessor expression stored
- * in the given expression tree. defined receives true or false,
- * indicating whether or not the expression has a definite value. If
- * defined receives true, the actual value is returned.
+/* Sweeps through the compiled expression and collects the
+ * identifiers that markdefined() would look up.
  */
-long evaltree(exptree *t, int *defined)
+int getidentifiers(exptree const *t, char const **ids, int max)
 {
-    long val1, val2;
-    int valued;
+    expcode const *x;
+    int count, n;
 
-    if (t->exp == expNone) {
-        if (defined)
-            *defined = FALSE;
-        return 0;
-    }
-    if (t->exp != expOperator) {
-        if (defined)
-            *defined = t->valued;
-        return t->valued ? t->value : 0;
+    count = 0;
+    for (n = 0 ; n < t->count ; ++n) {
+        x = &t->code[n];
+        if (x->exp == expDefined || x->exp == expMacro) {
+            if (count < max)
+                ids[count] = x->exp == expDefined ? x->identifier : x->begin;
+            ++count;
+        }
     }
+    return count;
+}
 
-    if (t->op < opPrefixCount) {
-        val1 = evaltree(t->child[0], &valued);
-        if (valued) {
-            switch (t->op) {
-              case opLogNot:    val1 = !val1;   break;
-              case opBitNot:    val1 = ~val1;   break;
-              case opPositive:  val1 = +val1;   break;
-              case opNegative:  val1 = -val1;   break;
-              default:                          break;
-            }
+/* Calculates the value of a single operator instruction, given the
+ * results of its subexpressions. Subexpressions that were skipped
+ * over are not consulted.
+ */
+static void evalcode(exptree *t, expcode *x)
+{
+    expcode const *a, *b, *c;
+    long val1, val2;
+    int valued;
+
+    a = &t->code[x->child[0]];
+    valued = a->valued;
+    val1 = a->value;
+    if (x->op < opPrefixCount) {
+        switch (x->op) {
+          case opLogNot:    val1 = !val1;   break;
+          case opBitNot:    val1 = ~val1;   break;
+          case opPositive:  val1 = +val1;   break;
+          case opNegative:  val1 = -val1;   break;
+          default:                          break;
         }
         goto done;
     }
-    val1 = evaltree(t->child[0], &valued);
-    if (t->op == opComma) {
-        val1 = evaltree(t->child[1], &valued);
+    b = &t->code[x->child[1]];
+    if (x->op == opComma) {
+        valued = b->valued;
+        val1 = b->value;
         goto done;
-    } else if (t->op == opConditional) {
+    } else if (x->op == opConditional) {
+        c = &t->code[x->child[2]];
         if (valued) {
-            val1 = evaltree(t->child[val1 ? 1 : 2], &valued);
+            valued = val1 ? b->valued : c->valued;
+            val1 = val1 ? b->value : c->value;
         } else {
-            val1 = evaltree(t->child[1], &valued);
-            if (valued) {
-                val2 = evaltree(t->child[2], &valued);
-                valued = valued && val1 == val2;
-            } else {
-                evaltree(t->child[2], NULL);
-            }
+            valued = b->valued && c->valued && b->value == c->value;
+            val1 = b->value;
         }
         goto done;
-    } else if (t->op == opLogAnd) {
-        if (valued) {
-            if (val1)
-                val1 = evaltree(t->child[1], &valued);
-        } else {
-            val1 = evaltree(t->child[1], &valued);
-            if (valued && val1)
-                valued = FALSE;
+    } else if (x->op == opLogAnd) {
+        if (!valued) {
+            valued = b->valued && !b->value;
+            val1 = b->value;
+        } else if (val1) {
+            valued = b->valued;
+            val1 = b->value;
         }
         goto done;
-    } else if (t->op == opLogOr) {
-        if (valued) {
-            if (!val1)
-                val1 = evaltree(t->child[1], &valued);
-        } else {
-            val1 = evaltree(t->child[1], &valued);
-            if (valued && !val1)
-                valued = FALSE;
+    } else if (x->op == opLogOr) {
+        if (!valued) {
+            valued = b->valued && b->value;
+            val1 = b->value;
+        } else if (!val1) {
+            valued = b->valued;
+            val1 = b->value;
         }
         goto done;
     }
     if (!valued)
         goto done;
 
-    val2 = evaltree(t->child[1], &valued);
+    valued = b->valued;
+    val2 = b->value;
     if (valued) {
-        if (val2 == 0 && (t->op == opDivide || t->op == opModulo)) {
+        if (val2 == 0 && (x->op == opDivide || x->op == opModulo)) {
             error(errZeroDiv);
             valued = FALSE;
             goto done;
         }
-        switch (t->op) {
+        switch (x->op) {
           case opLeftShift:     val1 = val1 << (int)val2;       break;
           case opRightShift:    val1 = val1 >> (int)val2;       break;
           case opLesserEqual:   val1 = val1 <= val2;            break;
@@ -652,61 +731,191 @@ long evaltree(exptree *t, int *defined)
     }
 
   done:
-    t->valued = valued;
+    x->valued = valued;
     if (valued)
-        t->value = val1;
+        x->value = val1;
+}
+
+/* Returns the index of the next instruction to evaluate after the
+ * nth one. Usually this is simply the following instruction, but
+ * once the first operand of an operator has been evaluated, the
+ * remaining operands are skipped over if they cannot affect the
+ * result: the unused branch of a ?: operator with a definite
+ * condition, the right operand of a && or || operator that has
+ * already been decided, and the right operand of an arithmetic
+ * operator whose left operand has no definite value.
+ */
+static int nextcode(exptree const *t, int n)
+{
+    expcode const *x, *p;
+
+    x = &t->code[n];
+    if (x->parent < 0)
+        return n + 1;
+    p = &t->code[x->parent];
+    if (n == p->child[0]) {
+        switch (p->op) {
+          case opConditional:
+            if (x->valued && !x->value)
+                return p->child[1] + 1;
+            break;
+          case opLogAnd:
+            if (x->valued && !x->value)
+                return x->parent;
+            break;
+          case opLogOr:
+            if (x->valued && x->value)
+                return x->parent;
+            break;
+          case opComma:
+            break;
+          default:
+            if (p->childcount > 1 && !x->valued)
+                return x->parent;
+            break;
+        }
+    } else if (n == p->child[1] && p->op == opConditional) {
+        if (t->code[p->child[0]].valued && t->code[p->child[0]].value)
+            return x->parent;
+    }
+    return n + 1;
+}
+
+/* Calculates the value of the parsed C preprocessor expression with a
+ * single sweep through its compiled form. defined receives true or
+ * false, indicating whether or not the expression has a definite
+ * value. If defined receives true, the actual value is returned.
+ */
+long evaltree(exptree *t, int *defined)
+{
+    int n;
+
+    if (t->root < 0) {
+        if (defined)
+            *defined = FALSE;
+        return 0;
+    }
+    for (n = 0 ; n <= t->root ; n = nextcode(t, n))
+        if (t->code[n].exp == expOperator)
+            evalcode(t, &t->code[n]);
     if (defined)
-        *defined = valued;
-    return valued ? val1 : 0;
+        *defined = t->code[t->root].valued;
+    return t->code[t->root].valued ? t->code[t->root].value : 0;
+}
+
+/* An alteration to the source of an expression made when unparsing
+ * it: the span is either removed or replaced with a value.
+ */
+typedef struct expedit {
+    char const *begin;          /* the start of the altered span */
+    char const *end;            /* the end of the altered span */
+    int         valued;         /* true if the span is replaced by value */
+    long        value;          /* the value to replace it with */
+} expedit;
+
+/* Compares two edits by their position in the source.
+ */
+static int cmpedits(void const *a, void const *b)
+{
+    expedit const *e1 = a;
+    expedit const *e2 = b;
+
+    return e1->begin < e2->begin ? -1 : e1->begin > e2->begin ? 1 : 0;
+}
+
+/* Adds an edit to the list, unless it would have no effect.
+ */
+static void addedit(expedit *edits, int *count, char const *begin,
+                    char const *end, int valued, long value)
+{
+    if (begin == end && !valued)
+        return;
+    edits[*count].begin = begin;
+    edits[*count].end = end;
+    edits[*count].valued = valued;
+    edits[*count].value = value;
+    ++*count;
+}
+
+/* Appends text to the buffer, if there is one, and returns its size.
+ */
+static int emit(char *buffer, char const *text, int size)
+{
+    if (buffer && size)
+        memcpy(buffer, text, size);
+    return size;
 }
 
 /* Extracts from the expression tree those parts that do not have a
  * defined value, and "unparses" that back into a C preprocessor
- * expression, storing the resulting source code in buffer.
+ * expression, storing the resulting source code in buffer. A reverse
+ * sweep through the compiled expression visits each instruction
+ * before its subexpressions, and determines which spans of the
+ * original source are to be removed or replaced by a value. The
+ * remaining source is then copied around these edits.
  */
 int unparseevaluated(exptree const *t, char *buffer)
 {
+    expcode const *x, *keep;
+    expedit *edits;
+    char *visit;
     char const *src;
-    char *buf;
-    int size;
-    int n;
+    char number[32];
+    int count, size, n, i;
 
-    if (t->exp == expNone)
+    if (t->root < 0)
         return 0;
-    if (t->valued)
-        return sprintf(buffer, "%ld", t->value);
-
-    if (t->exp != expOperator) {
-        size = getexplength(t);
-        memcpy(buffer, t->begin, size);
-        return size;
-    }
-    if (t->op == opConditional) {
-        if (t->child[0]->valued)
-            return unparseevaluated(t->child[t->child[0]->value ? 1 : 2],
-                                    buffer);
-    } else if (t->op == opLogAnd || t->op == opLogOr) {
-        if (t->child[0]->valued)
-            return unparseevaluated(t->child[1], buffer);
-        else if (t->child[1]->valued)
-            return unparseevaluated(t->child[0], buffer);
-    }
 
-    buf = buffer;
-    src = t->begin;
-    for (n = 0 ; n < t->childcount ; ++n) {
-        size = t->child[n]->begin - src;
-        if (size) {
-            memcpy(buf, src, size);
-            buf += size;
+    visit = allocate(t->root + 1);
+    memset(visit, FALSE, t->root + 1);
+    visit[t->root] = TRUE;
+    edits = allocate(2 * (t->root + 1) * sizeof *edits);
+    count = 0;
+    for (n = t->root ; n >= 0 ; --n) {
+        if (!visit[n])
+            continue;
+        x = &t->code[n];
+        if (x->valued) {
+            addedit(edits, &count, x->begin, x->end, TRUE, x->value);
+            continue;
+        }
+        if (x->exp != expOperator)
+            continue;
+        keep = NULL;
+        if (x->op == opConditional) {
+            if (t->code[x->child[0]].valued)
+                keep = &t->code[x->child[t->code[x->child[0]].value ? 1 : 2]];
+        } else if (x->op == opLogAnd || x->op == opLogOr) {
+            if (t->code[x->child[0]].valued)
+                keep = &t->code[x->child[1]];
+            else if (t->code[x->child[1]].valued)
+                keep = &t->code[x->child[0]];
+        }
+        if (keep) {
+            visit[keep - t->code] = TRUE;
+            addedit(edits, &count, x->begin, keep->begin, FALSE, 0);
+            addedit(edits, &count, keep->end, x->end, FALSE, 0);
+        } else {
+            for (i = 0 ; i < x->childcount ; ++i)
+                visit[x->child[i]] = TRUE;
         }
-        buf += unparseevaluated(t->child[n], buf);
-        src = t->child[n]->end;
     }
-    size = t->end - src;
-    if (size) {
-        memcpy(buf, src, size);
-        buf += size;
+    qsort(edits, count, sizeof *edits, cmpedits);
+
+    size = 0;
+    src = t->code[t->root].begin;
+    for (i = 0 ; i < count ; ++i) {
+        size += emit(buffer ? buffer + size : NULL, src,
+                     (int)(edits[i].begin - src));
+        if (edits[i].valued)
+            size += emit(buffer ? buffer + size : NULL, number,
+                         sprintf(number, "%ld", edits[i].value));
+        src = edits[i].end;
     }
-    return (int)(buf - buffer);
+    size += emit(buffer ? buffer + size : NULL, src,
+                 (int)(t->code[t->root].end - src));
+
+    deallocate(edits);
+    deallocate(visit);
+    return size;
 }
@@ -9,7 +9,10 @@
 /*
  * An expression tree parses and, where possible, evaluates C
  * preprocessor expressions. A parsed expression can then be evaluated
- * and to a limited degree edited.
+ * and to a limited degree edited. Despite the name, expressions are
+ * compiled into a flat array in postfix order rather than a tree of
+ * nodes, so that no part of this module recurses, and expressions
+ * nested to any depth can be handled.
  */
 
 #include "types.h"
@@ -22,7 +25,8 @@ extern exptree *initexptree(void);
  */
 extern void freeexptree(exptree *t);
 
-/* Resets an exptree back to its initial state.
+/* Resets an exptree back to its initial state. parseexptree() does
+ * this itself.
  */
 extern void clearexptree(exptree *t);
 
@@ -30,6 +34,10 @@ extern void clearexptree(exptree *t);
  */
 extern int getexplength(exptree const *t);
 
+/* Returns the number of operators and operands in the expression.
+ */
+extern int getexpnodecount(exptree const *t);
+
 /* Parses a C expression into an expression tree. exp points to the
  * expression to parse, potentially embedded inside of a larger
  * string, and cl provides a lexer initialized to exp's position. The
@@ -38,13 +46,22 @@ extern int getexplength(exptree const *t);
 extern char const *parseexptree(exptree *t, clexer *cl, char const *input);
 
 /* Runs through the parsed expression and marks all of the identifiers
- * that appear in set as having a specific definition state, either
- * defined or undefined according to the third argument.
- * (Sub-expressions consisting entirely of definite symbols are
- * themselves considered definite.) The return value is true if any
- * identifiers in set were found in the expression tree.
+ * that appear in either set as having a specific definition state,
+ * defined or undefined, as decided by resolvesymbol(). (Sub-expressions
+ * consisting entirely of definite symbols are themselves considered
+ * definite.) The return value is the number of identifiers found in
+ * the expression tree.
+ */
+extern int markdefined(exptree *t, symset const *defs, symset const *undefs);
+
+/* Stores pointers to the identifiers whose definitions can affect the
+ * parsed expression, namely simple macros and the operands of the
+ * defined operator, in ids, up to a maximum of max. The pointers
+ * point into the parsed source, and so are not NUL-terminated. ids
+ * can be NULL if max is zero. The return value is the total number of
+ * identifiers found.
  */
-extern int markdefined(exptree *t, symset const *set, int defined);
+extern int getidentifiers(exptree const *t, char const **ids, int max);
 
 /* Attempts to evaluate the parsed expression's value. If the
  * expression has a definite value, it is returned and defined
@@ -56,8 +73,10 @@ extern long evaltree(exptree *t, int *defined);
 /* Copy into buffer the part of the parsed expression that lacks a
  * definition state. Any sub-expressions that have a definite value
  * are applied and do not form part of the output. The return value is
- * the length of the string written to buffer. This string is
- * guaranteed not to be longer than the original parsed expression.
+ * the length of the string written to buffer. The string is not
+ * NUL-terminated. It can be longer than the original parsed
+ * expression, since a value can have more digits than the source
+ * that it replaces, so buffer can be NULL to only obtain the length.
  */
 extern int unparseevaluated(exptree const *t, char *buffer);
 
@@ -3,37 +3,304 @@
  */
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#if !defined NO_THREADS && !defined __GNUC__
+#include <pthread.h>
+#endif
 #include "gen.h"
 
-/* Wrapper for malloc().
+/* The default functions that memory is obtained from.
  */
-void *allocate(size_t size)
+#ifndef CPPP_MALLOC
+#define CPPP_MALLOC malloc
+#endif
+#ifndef CPPP_REALLOC
+#define CPPP_REALLOC realloc
+#endif
+#ifndef CPPP_FREE
+#define CPPP_FREE free
+#endif
+
+/* Storage that is separate for each thread. When built with
+ * NO_THREADS, there is only the one thread.
+ */
+#if defined NO_THREADS
+#define THREADLOCAL
+#elif defined __STDC_VERSION__ && __STDC_VERSION__ >= 201112L
+#define THREADLOCAL _Thread_local
+#else
+#define THREADLOCAL __thread
+#endif
+
+/* The statistics are updated from every thread, on every allocation,
+ * and so are kept with atomic operations rather than behind a lock.
+ * Compilers without the atomic builtins fall back to a lock, unless
+ * there is only the one thread.
+ */
+#ifdef __GNUC__
+#define addstat(p, n)   __atomic_add_fetch((p), (n), __ATOMIC_RELAXED)
+#define loadstat(p)     __atomic_load_n((p), __ATOMIC_RELAXED)
+#define storestat(p, n) __atomic_store_n((p), (n), __ATOMIC_RELAXED)
+#define lockstats()     ((void)0)
+#define unlockstats()   ((void)0)
+#else
+#define addstat(p, n)   (*(p) += (n))
+#define loadstat(p)     (*(p))
+#define storestat(p, n) (*(p) = (n))
+#ifdef NO_THREADS
+#define lockstats()     ((void)0)
+#define unlockstats()   ((void)0)
+#else
+#define lockstats()     pthread_mutex_lock(&statslock)
+#define unlockstats()   pthread_mutex_unlock(&statslock)
+static pthread_mutex_t statslock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+#endif
+
+/* The bookkeeping that precedes every allocated block. The union
+ * ensures that the block that follows is suitably aligned.
+ */
+typedef union memheader {
+    struct {
+        size_t  size;           /* the size of the block */
+        int     tag;            /* the subsystem that allocated it */
+        allocator const *from;  /* the allocator it came from, or NULL */
+    } info;
+    long double align;
+    void       *ptr;
+} memheader;
+
+/* The calling thread's allocator, if not the default.
+ */
+static THREADLOCAL allocator const *current = NULL;
+
+/* The statistics for each subsystem, followed by the totals.
+ */
+static memstats stats[memTagCount + 1];
+
+/* The names of the subsystems.
+ */
+static char const *const tagnames[memTagCount + 1] = {
+    "other", "mstr", "exptree", "symset", "clexer", "ppproc", "udiff",
+    "deps", "compdb", "journal", "total"
+};
+
+/* Exits the program after an allocation fails.
+ */
+static void outofmemory(void)
 {
-    void *p;
+    fputs("Out of memory.\n", stderr);
+    exit(EXIT_FAILURE);
+}
+
+/* The kinds of events recorded in the statistics.
+ */
+enum memevent { evAlloc, evResize, evRelease };
 
-    p = malloc(size);
-    if (!p) {
-        fputs("Out of memory.\n", stderr);
-        exit(EXIT_FAILURE);
+/* Records an event in the statistics for a subsystem and in the
+ * totals. oldsize and newsize give the size of the block before and
+ * after the event.
+ */
+static void account(int tag, enum memevent event,
+                    size_t oldsize, size_t newsize)
+{
+    memstats *s;
+    size_t bytes, peak;
+    int i;
+
+    lockstats();
+    for (i = 0 ; i < 2 ; ++i) {
+        s = &stats[i ? memTagCount : tag];
+        if (event == evAlloc) {
+            addstat(&s->allocs, 1);
+        } else if (event == evRelease) {
+            addstat(&s->frees, 1);
+        } else {
+            addstat(&s->reallocs, 1);
+            if (newsize > oldsize)
+                addstat(&s->reallocbytes, newsize - oldsize);
+        }
+        bytes = addstat(&s->bytes, newsize - oldsize);
+        if (newsize <= oldsize)
+            continue;
+        peak = loadstat(&s->peak);
+#ifdef __GNUC__
+        while (bytes > peak && !__atomic_compare_exchange_n(&s->peak, &peak,
+                                        bytes, TRUE, __ATOMIC_RELAXED,
+                                        __ATOMIC_RELAXED)) ;
+#else
+        if (bytes > peak)
+            s->peak = bytes;
+#endif
     }
-    return p;
+    unlockstats();
 }
 
-/* Wrapper for realloc().
+/* Wrapper for malloc(), recording the block's size and subsystem, and
+ * the allocator it came from.
  */
-void *reallocate(void *p, size_t size)
+void *allocatetagged(size_t size, int tag)
 {
-    p = realloc(p, size);
-    if (!p) {
-        fputs("Out of memory.\n", stderr);
-        exit(EXIT_FAILURE);
-    }
-    return p;
+    memheader *h;
+
+    if (current && current->alloc)
+        h = current->alloc(sizeof *h + size, current->data);
+    else
+        h = CPPP_MALLOC(sizeof *h + size);
+    if (!h)
+        outofmemory();
+    h->info.size = size;
+    h->info.tag = tag;
+    h->info.from = current;
+    account(tag, evAlloc, 0, size);
+    return h + 1;
+}
+
+/* Wrapper for realloc(). The block remains attributed to the
+ * subsystem that first allocated it, and is resized by the allocator
+ * it came from, whichever thread this is.
+ */
+void *reallocatetagged(void *p, size_t size, int tag)
+{
+    allocator const *from;
+    memheader *h;
+    size_t oldsize;
+
+    if (!p)
+        return allocatetagged(size, tag);
+    h = (memheader*)p - 1;
+    oldsize = h->info.size;
+    tag = h->info.tag;
+    from = h->info.from;
+    if (from && from->resize)
+        h = from->resize(h, sizeof *h + size, from->data);
+    else
+        h = CPPP_REALLOC(h, sizeof *h + size);
+    if (!h)
+        outofmemory();
+    h->info.size = size;
+    account(tag, evResize, oldsize, size);
+    return h + 1;
 }
 
-/* Wrapper for free().
+/* Wrapper for free(), returning the block to the allocator it came
+ * from.
  */
 void deallocate(void *p)
 {
-    free(p);
+    allocator const *from;
+    memheader *h;
+
+    if (!p)
+        return;
+    h = (memheader*)p - 1;
+    from = h->info.from;
+    account(h->info.tag, evRelease, h->info.size, 0);
+    if (from && from->release)
+        from->release(h, from->data);
+    else
+        CPPP_FREE(h);
+}
+
+/* Selects the calling thread's allocator.
+ */
+void setallocator(allocator const *a)
+{
+    current = a;
+}
+
+/* Returns the calling thread's allocator.
+ */
+allocator const *getallocator(void)
+{
+    return current;
+}
+
+/* Retrieves the statistics for a subsystem, or all of them.
+ */
+void getmemstats(int tag, memstats *s)
+{
+    if (tag < 0 || tag > memTagCount)
+        tag = memTagCount;
+    lockstats();
+    s->allocs = loadstat(&stats[tag].allocs);
+    s->frees = loadstat(&stats[tag].frees);
+    s->reallocs = loadstat(&stats[tag].reallocs);
+    s->reallocbytes = loadstat(&stats[tag].reallocbytes);
+    s->bytes = loadstat(&stats[tag].bytes);
+    s->peak = loadstat(&stats[tag].peak);
+    unlockstats();
+}
+
+/* Lowers each peak to the current usage.
+ */
+void resetmempeak(void)
+{
+    int i;
+
+    lockstats();
+    for (i = 0 ; i <= memTagCount ; ++i)
+        storestat(&stats[i].peak, loadstat(&stats[i].bytes));
+    unlockstats();
+}
+
+/* Returns the name of a subsystem.
+ */
+char const *getmemtagname(int tag)
+{
+    if (tag < 0 || tag > memTagCount)
+        tag = memTagCount;
+    return tagnames[tag];
+}
+
+/* Resets the hashes to their starting values.
+ */
+void initcontentkey(contentkey *key)
+{
+    key->size = 0;
+    key->hash[0] = 2166136261UL;
+    key->hash[1] = 5381;
+}
+
+/* Adds more of the text to the hashes.
+ */
+void addtocontentkey(contentkey *key, char const *buf, size_t size)
+{
+    unsigned long h0, h1;
+    size_t i;
+
+    h0 = key->hash[0];
+    h1 = key->hash[1];
+    for (i = 0 ; i < size ; ++i) {
+        h0 = ((h0 ^ (unsigned char)buf[i]) * 16777619UL) & 0xFFFFFFFFUL;
+        h1 = ((h1 * 33) ^ (unsigned char)buf[i]) & 0xFFFFFFFFUL;
+    }
+    key->hash[0] = h0;
+    key->hash[1] = h1;
+    key->size += size;
+}
+
+/* Writes text to a stdio stream.
+ */
+int writetofile(char const *text, size_t size, void *data)
+{
+    return !size || fwrite(text, size, 1, data) == 1;
+}
+
+/* Appends text to a textbuffer, growing it as necessary.
+ */
+int appendtobuffer(char const *text, size_t size, void *data)
+{
+    textbuffer *tb = data;
+
+    if (tb->size + size > tb->allocated) {
+        tb->allocated = tb->allocated ? 2 * tb->allocated : 256;
+        if (tb->allocated < tb->size + size)
+            tb->allocated = tb->size + size;
+        tb->buf = reallocate(tb->buf, tb->allocated);
+    }
+    if (size)
+        memcpy(tb->buf + tb->size, text, size);
+    tb->size += size;
+    return 1;
 }
@@ -9,6 +9,7 @@
  */
 
 #include <stddef.h>
+#include "types.h"
 
 #ifndef TRUE
 #define TRUE  1
@@ -23,11 +24,126 @@
  */
 #define _issym(ch) (isalnum(ch) || (ch) == '_')
 
+/* The subsystems that allocated memory is attributed to. A source
+ * file selects its subsystem by defining MEMTAG before including
+ * this header.
+ */
+enum memtag
+{
+    memOther = 0,               /* anything not listed below */
+    memMstr,                    /* modifiable strings */
+    memExptree,                 /* parsed #if expressions */
+    memSymset,                  /* symbol sets */
+    memClexer,                  /* the lexer */
+    memPpproc,                  /* the preprocessor and its buffers */
+    memUdiff,                   /* edit scripts */
+    memDeps,                    /* dependency indexes */
+    memCompdb,                  /* compilation databases */
+    memJournal,                 /* the journal of completed files */
+    memTagCount
+};
+
+#ifndef MEMTAG
+#define MEMTAG memOther
+#endif
+
 /* Memory allocation functions. These functions either succeed or exit
- * the program.
+ * the program. The memory is attributed to the calling source file's
+ * subsystem.
  */
-extern void *allocate(size_t size);
-extern void *reallocate(void *ptr, size_t size);
+#define allocate(size) allocatetagged((size), MEMTAG)
+#define reallocate(ptr, size) reallocatetagged((ptr), (size), MEMTAG)
+extern void *allocatetagged(size_t size, int tag);
+extern void *reallocatetagged(void *ptr, size_t size, int tag);
 extern void deallocate(void *ptr);
 
+/* A set of functions that memory is obtained from. resize and
+ * release must accept any pointer returned by alloc or resize, and
+ * data is passed to each of them unchanged. Any of them may be NULL
+ * to use the default.
+ */
+typedef struct allocator {
+    void       *(*alloc)(size_t size, void *data);
+    void       *(*resize)(void *ptr, size_t size, void *data);
+    void        (*release)(void *ptr, void *data);
+    void       *data;
+} allocator;
+
+/* Selects the functions that the calling thread obtains memory from,
+ * or restores the defaults if a is NULL. The setting is separate for
+ * each thread, so that each can draw on its own arena. Every block
+ * records the allocator it came from, and is always resized and
+ * released through it, from whichever thread; a must therefore remain
+ * valid until all of the blocks it provided have been released. The
+ * defaults are malloc(), realloc() and free(), unless other functions
+ * are named by defining CPPP_MALLOC, CPPP_REALLOC and CPPP_FREE when
+ * compiling gen.c. Threads that the library starts for -j work use the
+ * allocator of the thread that started them.
+ */
+extern void setallocator(allocator const *a);
+
+/* Returns the calling thread's allocator, or NULL for the defaults.
+ */
+extern allocator const *getallocator(void);
+
+/* Statistics on the memory allocated by one subsystem, or by all of
+ * them together.
+ */
+typedef struct memstats {
+    unsigned long allocs;       /* the number of blocks allocated */
+    unsigned long frees;        /* the number of blocks released */
+    unsigned long reallocs;     /* the number of times a block was resized */
+    size_t      reallocbytes;   /* the total growth from resizing blocks */
+    size_t      bytes;          /* the number of bytes currently allocated */
+    size_t      peak;           /* the highest value of bytes so far */
+} memstats;
+
+/* Retrieves the statistics for the given subsystem, or for all of them
+ * together if tag is memTagCount.
+ */
+extern void getmemstats(int tag, memstats *stats);
+
+/* Resets the peak usage of every subsystem to its current usage, so
+ * that the peak of a single task can be measured.
+ */
+extern void resetmempeak(void);
+
+/* Returns a short name for the given subsystem.
+ */
+extern char const *getmemtagname(int tag);
+
+/* The identity of a text: its length, and two independent 32-bit
+ * hashes of its contents (FNV-1a and djb2).
+ */
+struct contentkey {
+    unsigned long size;         /* the length of the text */
+    unsigned long hash[2];      /* the two hashes of the text */
+};
+
+/* Initializes a content key to that of an empty text.
+ */
+extern void initcontentkey(contentkey *key);
+
+/* Updates a content key with the next size bytes of the text.
+ */
+extern void addtocontentkey(contentkey *key, char const *buf, size_t size);
+
+/* A textsink (see types.h) that writes to the stdio stream given as data.
+ */
+extern int writetofile(char const *text, size_t size, void *data);
+
+/* A growable buffer that collects output text in memory.
+ */
+typedef struct textbuffer {
+    char       *buf;            /* the collected text, or NULL */
+    size_t      size;           /* the length of the collected text */
+    size_t      allocated;      /* the size of the buffer */
+} textbuffer;
+
+/* A textsink that appends to the textbuffer given as data. The
+ * textbuffer should start out zeroed, and its buf freed with
+ * deallocate() when it is no longer needed.
+ */
+extern int appendtobuffer(char const *text, size_t size, void *data);
+
 #endif
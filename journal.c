@@ -0,0 +1,329 @@
+/* journal.c: Copyright (C) 2022 by Brian Raiter <breadbox@muppetlabs.com>
+ * License GPLv2+: GNU GPL version 2 or later.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#define MEMTAG memJournal
+#include "gen.h"
+#include "types.h"
+#include "unixisms.h"
+#include "journal.h"
+
+/* The first line of every journal file.
+ */
+#define JOURNAL_HEADER  "cppp journal 1"
+
+/* The number of records, and the number of seconds, that may go by
+ * before the journal is synced to the disk.
+ */
+#define SYNC_RECORDS    256
+#define SYNC_SECONDS    2
+
+/* The record of one completed file. The two names are stored one
+ * after the other, each terminated by a NUL.
+ */
+typedef struct record {
+    struct record *next;        /* the next record in the same bucket */
+    char       *names;          /* the input and output pathnames */
+    contentkey  in;             /* the contents of the input file */
+    contentkey  config;         /* the symbol configuration */
+    contentkey  out;            /* the contents of the output file */
+} record;
+
+/* An open journal, with the records of earlier runs in a hash table
+ * indexed by their pathnames.
+ */
+struct journal {
+    FILE       *fp;             /* the journal file */
+    record    **buckets;        /* the hash table's chains of records */
+    int         bucketcount;    /* the number of chains in the table */
+    int         count;          /* the number of records in the table */
+    int         unsynced;       /* records written since the last sync */
+    time_t      lastsync;       /* when the journal was last synced */
+    int         failed;         /* true if a record could not be written */
+};
+
+/* Returns the hash of a pair of pathnames.
+ */
+static unsigned long hashnames(char const *inname, char const *outname)
+{
+    contentkey key;
+
+    initcontentkey(&key);
+    addtocontentkey(&key, inname, strlen(inname) + 1);
+    addtocontentkey(&key, outname, strlen(outname));
+    return key.hash[0];
+}
+
+/* Returns the record for a pair of pathnames, or NULL if there is
+ * none.
+ */
+static record *findrecord(journal const *j, char const *inname,
+                          char const *outname)
+{
+    record *rec;
+
+    if (!j->bucketcount)
+        return NULL;
+    rec = j->buckets[hashnames(inname, outname) % j->bucketcount];
+    for ( ; rec ; rec = rec->next)
+        if (!strcmp(rec->names, inname)
+                && !strcmp(rec->names + strlen(rec->names) + 1, outname))
+            return rec;
+    return NULL;
+}
+
+/* Adds a record to the hash table, replacing any earlier record for
+ * the same pathnames. The table is enlarged as needed to keep the
+ * chains short.
+ */
+static void addrecord(journal *j, char const *inname, char const *outname,
+                      record const *keys)
+{
+    record **buckets;
+    record *rec, *next;
+    size_t insize, outsize;
+    int count, i, n;
+
+    if ((rec = findrecord(j, inname, outname))) {
+        rec->in = keys->in;
+        rec->config = keys->config;
+        rec->out = keys->out;
+        return;
+    }
+    if (j->count >= j->bucketcount) {
+        count = j->bucketcount ? 2 * j->bucketcount : 256;
+        buckets = allocate(count * sizeof *buckets);
+        for (i = 0 ; i < count ; ++i)
+            buckets[i] = NULL;
+        for (i = 0 ; i < j->bucketcount ; ++i) {
+            for (rec = j->buckets[i] ; rec ; rec = next) {
+                next = rec->next;
+                n = hashnames(rec->names, rec->names + strlen(rec->names) + 1)
+                        % count;
+                rec->next = buckets[n];
+                buckets[n] = rec;
+            }
+        }
+        deallocate(j->buckets);
+        j->buckets = buckets;
+        j->bucketcount = count;
+    }
+    rec = allocate(sizeof *rec);
+    insize = strlen(inname) + 1;
+    outsize = strlen(outname) + 1;
+    rec->names = allocate(insize + outsize);
+    memcpy(rec->names, inname, insize);
+    memcpy(rec->names + insize, outname, outsize);
+    rec->in = keys->in;
+    rec->config = keys->config;
+    rec->out = keys->out;
+    n = hashnames(inname, outname) % j->bucketcount;
+    rec->next = j->buckets[n];
+    j->buckets[n] = rec;
+    ++j->count;
+}
+
+/* Reads one line from the journal file into an allocated buffer,
+ * without its newline. The return value is the number of bytes read,
+ * including the newline, or zero at the end of the file. A final line
+ * without a newline is read, so that the caller can discard it.
+ */
+static size_t readrecordline(FILE *fp, char **pbuf, size_t *palloc,
+                             int *complete)
+{
+    size_t n;
+    int ch;
+
+    n = 0;
+    *complete = FALSE;
+    while ((ch = fgetc(fp)) != EOF) {
+        if (n + 1 >= *palloc) {
+            *palloc = *palloc ? 2 * *palloc : 256;
+            *pbuf = reallocate(*pbuf, *palloc);
+        }
+        if (ch == '\n') {
+            *complete = TRUE;
+            (*pbuf)[n] = '\0';
+            return n + 1;
+        }
+        (*pbuf)[n++] = ch;
+    }
+    if (n)
+        (*pbuf)[n] = '\0';
+    return n;
+}
+
+/* Parses one line of the journal and adds it to the table. Lines that
+ * are not valid records are ignored.
+ */
+static void parserecord(journal *j, char *line)
+{
+    record keys;
+    char *inname, *outname;
+    int n;
+
+    n = 0;
+    if (sscanf(line, "%lu %lx %lx %lu %lx %lx %lu %lx %lx%n",
+               &keys.in.size, &keys.in.hash[0], &keys.in.hash[1],
+               &keys.config.size, &keys.config.hash[0],
+               &keys.config.hash[1], &keys.out.size, &keys.out.hash[0],
+               &keys.out.hash[1], &n) < 9 || !n || line[n] != '\t')
+        return;
+    inname = line + n + 1;
+    if (!(outname = strchr(inname, '\t')))
+        return;
+    *outname++ = '\0';
+    if (!*inname || !*outname || strchr(outname, '\t'))
+        return;
+    addrecord(j, inname, outname, &keys);
+}
+
+/* Opens the journal and loads its records, and then positions the
+ * file for appending. If the last line was cut short, it is ended
+ * with a newline so that the next record starts on its own line.
+ */
+journal *openjournal(char const *filename)
+{
+    journal *j;
+    char *line;
+    size_t alloc, n;
+    int complete, ended, first, err;
+
+    j = allocate(sizeof *j);
+    j->buckets = NULL;
+    j->bucketcount = 0;
+    j->count = 0;
+    j->unsynced = 0;
+    j->lastsync = time(NULL);
+    j->failed = FALSE;
+    if (!(j->fp = fopen(filename, "a+b"))) {
+        deallocate(j);
+        return NULL;
+    }
+    rewind(j->fp);
+
+    line = NULL;
+    alloc = 0;
+    ended = TRUE;
+    first = TRUE;
+    err = 0;
+    while ((n = readrecordline(j->fp, &line, &alloc, &complete))) {
+        ended = complete;
+        if (first) {
+            if (!complete || strcmp(line, JOURNAL_HEADER)) {
+                err = EINVAL;
+                break;
+            }
+            first = FALSE;
+        } else if (complete) {
+            parserecord(j, line);
+        }
+    }
+    deallocate(line);
+    if (!err && ferror(j->fp))
+        err = errno ? errno : EIO;
+    if (!err && fseek(j->fp, 0, SEEK_END))
+        err = errno;
+    if (!err && first)
+        fputs(JOURNAL_HEADER "\n", j->fp);
+    else if (!err && !ended)
+        fputc('\n', j->fp);
+    if (!err && (fflush(j->fp) || ferror(j->fp)))
+        err = errno ? errno : EIO;
+    if (err) {
+        j->failed = TRUE;
+        closejournal(j);
+        errno = err == EINVAL ? 0 : err;
+        return NULL;
+    }
+    return j;
+}
+
+/* Syncs the journal, closes the file, and discards the records.
+ */
+int closejournal(journal *j)
+{
+    record *rec, *next;
+    int ret, i;
+
+    syncjournal(j);
+    if (fclose(j->fp))
+        j->failed = TRUE;
+    ret = !j->failed;
+    for (i = 0 ; i < j->bucketcount ; ++i) {
+        for (rec = j->buckets[i] ; rec ; rec = next) {
+            next = rec->next;
+            deallocate(rec->names);
+            deallocate(rec);
+        }
+    }
+    deallocate(j->buckets);
+    deallocate(j);
+    return ret;
+}
+
+/* Compares a record with the current input and configuration.
+ */
+int findjournal(journal const *j, char const *inname, char const *outname,
+                contentkey const *in, contentkey const *config,
+                contentkey *out)
+{
+    record const *rec;
+
+    if (!(rec = findrecord(j, inname, outname)))
+        return FALSE;
+    if (rec->in.size != in->size || rec->in.hash[0] != in->hash[0]
+                                 || rec->in.hash[1] != in->hash[1])
+        return FALSE;
+    if (rec->config.size != config->size
+                || rec->config.hash[0] != config->hash[0]
+                || rec->config.hash[1] != config->hash[1])
+        return FALSE;
+    *out = rec->out;
+    return TRUE;
+}
+
+/* Writes a record as a single line, and flushes it immediately so
+ * that it survives the program being killed. Syncing to the disk,
+ * which is what makes it survive a crash of the whole system, is
+ * done in batches.
+ */
+int addjournal(journal *j, char const *inname, char const *outname,
+               contentkey const *in, contentkey const *config,
+               contentkey const *out)
+{
+    if (strpbrk(inname, "\t\n") || strpbrk(outname, "\t\n"))
+        return TRUE;
+    fprintf(j->fp, "%lu %08lx %08lx %lu %08lx %08lx %lu %08lx %08lx",
+            in->size, in->hash[0], in->hash[1],
+            config->size, config->hash[0], config->hash[1],
+            out->size, out->hash[0], out->hash[1]);
+    fprintf(j->fp, "\t%s\t%s\n", inname, outname);
+    if (fflush(j->fp) || ferror(j->fp)) {
+        j->failed = TRUE;
+        return FALSE;
+    }
+    ++j->unsynced;
+    if (j->unsynced >= SYNC_RECORDS
+                || time(NULL) - j->lastsync >= SYNC_SECONDS)
+        return syncjournal(j);
+    return TRUE;
+}
+
+/* Syncs the journal file if any records have been written since the
+ * last time.
+ */
+int syncjournal(journal *j)
+{
+    if (!j->unsynced)
+        return !j->failed;
+    if (!syncfile(j->fp))
+        j->failed = TRUE;
+    j->unsynced = 0;
+    j->lastsync = time(NULL);
+    return !j->failed;
+}
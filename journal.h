@@ -0,0 +1,57 @@
+/* journal.h: Copyright (C) 2022 by Brian Raiter <breadbox@muppetlabs.com>
+ * License GPLv2+: GNU GPL version 2 or later.
+ */
+#ifndef _journal_h_
+#define _journal_h_
+
+/*
+ * A journal records each input file that has been completely
+ * processed, so that a long run which is interrupted can be resumed
+ * without repeating that work. A record gives the input and output
+ * pathnames, the content key of the input, a key identifying the
+ * symbol configuration, and the content key of the output. Records
+ * are appended to the file one line at a time and flushed as they are
+ * made, and are synced to the disk in batches. A record that was cut
+ * short by a crash is ignored when the journal is read again.
+ */
+
+#include "types.h"
+
+/* Opens the journal file, creating it if it does not exist, and reads
+ * the records of earlier runs. The return value is NULL if the file
+ * could not be opened or read, in which case errno is set, or if the
+ * file is not a journal, in which case errno is zero.
+ */
+extern journal *openjournal(char const *filename);
+
+/* Syncs and closes the journal file. The return value is false if any
+ * record could not be written.
+ */
+extern int closejournal(journal *j);
+
+/* Looks for a record, made by an earlier run, of the given input and
+ * output files having been processed with the given input contents
+ * and configuration. If one
+ * is found, the return value is true, and out receives the content
+ * key that the output file had.
+ */
+extern int findjournal(journal const *j, char const *inname,
+                       char const *outname, contentkey const *in,
+                       contentkey const *config, contentkey *out);
+
+/* Appends a record of a completed file. The journal is synced to the
+ * disk when enough records have accumulated, or enough time has
+ * passed, since the last sync. Files whose names contain tabs or
+ * newlines are not recorded. The return value is false if the record
+ * could not be written.
+ */
+extern int addjournal(journal *j, char const *inname, char const *outname,
+                      contentkey const *in, contentkey const *config,
+                      contentkey const *out);
+
+/* Syncs any records that have not yet been synced to the disk. The
+ * return value is false if an error occurs.
+ */
+extern int syncjournal(journal *j);
+
+#endif
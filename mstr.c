@@ -4,6 +4,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <limits.h>
+#define MEMTAG memMstr
 #include "gen.h"
 #include "types.h"
 #include "mstr.h"
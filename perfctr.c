@@ -0,0 +1,265 @@
+/* perfctr.c: Copyright (C) 2022 by Brian Raiter <breadbox@muppetlabs.com>
+ * License GPLv2+: GNU GPL version 2 or later.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+#include "gen.h"
+#include "perfctr.h"
+
+/* The state of the counters. The events are opened as a single group,
+ * so that they can all be read with one system call, and slot gives
+ * each event's position in the group, or -1 if it is not counted.
+ */
+static struct {
+    int         active;         /* true while the counters are running */
+    int         phase;          /* the phase being counted */
+    int         members;        /* the number of events in the group */
+    int         fds[eventCount];        /* the open counters */
+    int         slot[eventCount];       /* each event's place in the group */
+    unsigned long long last[eventCount];        /* the previous reading */
+    unsigned long long counts[phaseCount][eventCount];  /* the totals */
+    unsigned long long running; /* how long the group has been counting */
+    unsigned long long input;   /* the number of bytes of input */
+} perf = { FALSE, phaseOther, 0, { -1, -1, -1, -1, -1 },
+           { -1, -1, -1, -1, -1 }, { 0 }, { { 0 } }, 0, 0 };
+
+static char const *const phasenames[phaseCount] = {
+    "other", "read", "line", "if", "write"
+};
+
+static char const *const eventnames[eventCount] = {
+    "cycles", "instrs", "br-miss", "L1-miss", "LLC-miss"
+};
+
+#ifdef __linux__
+
+/* The type and configuration of each event.
+ */
+static struct { unsigned int type; unsigned long long config; }
+const eventconfigs[eventCount] = {
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+    { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D
+                        | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                        | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+    { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL
+                        | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                        | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) }
+};
+
+/* Opens a counter for one event in the calling thread, as a member of
+ * the group led by leader, or as the leader if it is -1. Only the
+ * program's own code is counted, which also keeps the system calls
+ * that read the counters out of the counts.
+ */
+static int openevent(int event, int leader)
+{
+    struct perf_event_attr attr;
+
+    memset(&attr, 0, sizeof attr);
+    attr.size = sizeof attr;
+    attr.type = eventconfigs[event].type;
+    attr.config = eventconfigs[event].config;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED
+                                         | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0);
+}
+
+/* Returns the file descriptor of the group leader.
+ */
+static int leaderfd(void)
+{
+    int i;
+
+    for (i = 0 ; i < eventCount ; ++i)
+        if (perf.slot[i] == 0)
+            return perf.fds[i];
+    return -1;
+}
+
+#endif
+
+/* Closes all of the counters.
+ */
+static void closeevents(void)
+{
+    int i;
+
+    for (i = 0 ; i < eventCount ; ++i) {
+        if (perf.fds[i] >= 0) {
+#ifdef __linux__
+            close(perf.fds[i]);
+#endif
+            perf.fds[i] = -1;
+        }
+    }
+}
+
+/* Closes the counters and marks every event as not counted.
+ */
+static void giveup(void)
+{
+    int i;
+
+    closeevents();
+    for (i = 0 ; i < eventCount ; ++i)
+        perf.slot[i] = -1;
+    perf.members = 0;
+    perf.active = FALSE;
+}
+
+/* Reads the counters and adds the counts since the previous reading to
+ * the current phase. If the counters cannot be read, they are given up
+ * on.
+ */
+static void takereading(void)
+{
+#ifdef __linux__
+    unsigned long long buf[3 + eventCount];
+    unsigned long long value;
+    ssize_t n;
+    int i;
+
+    n = read(leaderfd(), buf, sizeof buf);
+    if (n < (ssize_t)((3 + perf.members) * sizeof *buf)) {
+        giveup();
+        return;
+    }
+    perf.running = buf[2];
+    for (i = 0 ; i < eventCount ; ++i) {
+        if (perf.slot[i] >= 0) {
+            value = buf[3 + perf.slot[i]];
+            perf.counts[perf.phase][i] += value - perf.last[i];
+            perf.last[i] = value;
+        }
+    }
+#endif
+}
+
+/* Opens each event that the system supports as part of one group, and
+ * takes an initial reading.
+ */
+int startperfcounters(void)
+{
+#ifdef __linux__
+    int leader, err, i;
+
+    leader = -1;
+    err = 0;
+    perf.members = 0;
+    for (i = 0 ; i < eventCount ; ++i) {
+        perf.fds[i] = openevent(i, leader);
+        if (perf.fds[i] < 0) {
+            if (!err)
+                err = errno;
+            perf.slot[i] = -1;
+            continue;
+        }
+        if (leader < 0)
+            leader = perf.fds[i];
+        perf.slot[i] = perf.members++;
+    }
+    if (!perf.members) {
+        errno = err;
+        return FALSE;
+    }
+    for (i = 0 ; i < eventCount ; ++i)
+        perf.last[i] = 0;
+    perf.active = TRUE;
+    takereading();
+    if (!perf.active) {
+        errno = ENODEV;
+        return FALSE;
+    }
+    return TRUE;
+#else
+    errno = ENOSYS;
+    return FALSE;
+#endif
+}
+
+/* Takes a final reading, and closes the counters. If the group was
+ * never given any time on the hardware, which happens when it has more
+ * events than the hardware can count at once, the counts are
+ * meaningless.
+ */
+void stopperfcounters(void)
+{
+    if (!perf.active)
+        return;
+    takereading();
+    if (perf.active && !perf.running)
+        giveup();
+    closeevents();
+    perf.active = FALSE;
+}
+
+/* Attributes the counts so far to the current phase before changing
+ * it.
+ */
+int setperfphase(int phase)
+{
+    int prev;
+
+    prev = perf.phase;
+    if (perf.active && phase != prev)
+        takereading();
+    perf.phase = phase;
+    return prev;
+}
+
+/* Adds to the input size.
+ */
+void addperfinput(size_t size)
+{
+    perf.input += size;
+}
+
+/* Returns the input size.
+ */
+unsigned long long getperfinput(void)
+{
+    return perf.input;
+}
+
+/* Returns a count, or the sum of the counts for every phase.
+ */
+int getperfcount(int phase, int event, unsigned long long *count)
+{
+    int i;
+
+    if (perf.slot[event] < 0)
+        return FALSE;
+    if (phase < phaseCount) {
+        *count = perf.counts[phase][event];
+    } else {
+        *count = 0;
+        for (i = 0 ; i < phaseCount ; ++i)
+            *count += perf.counts[i][event];
+    }
+    return TRUE;
+}
+
+/* Returns the name of a phase.
+ */
+char const *getperfphasename(int phase)
+{
+    return phase < phaseCount ? phasenames[phase] : "total";
+}
+
+/* Returns the name of an event.
+ */
+char const *getperfeventname(int event)
+{
+    return eventnames[event];
+}
@@ -0,0 +1,75 @@
+/* perfctr.h: Copyright (C) 2022 by Brian Raiter <breadbox@muppetlabs.com>
+ * License GPLv2+: GNU GPL version 2 or later.
+ */
+#ifndef _perfctr_h_
+#define _perfctr_h_
+
+/*
+ * Hardware performance counters, for measuring where the program's
+ * time goes. Once the counters are started, the counts are attributed
+ * to whichever phase of processing is current, and the phase is
+ * changed as the preprocessor moves between reading, examining and
+ * writing each line. The counters only follow the thread that started
+ * them. Where the counters are unavailable, as is often the case
+ * inside containers and virtual machines, the functions do nothing.
+ */
+
+#include <stddef.h>
+
+/* The phases of processing that counts are attributed to.
+ */
+enum perfphase {
+    phaseOther = 0,             /* everything outside of the phases below */
+    phaseRead,                  /* reading lines of input */
+    phaseLine,                  /* examining a line, aside from #if */
+    phaseIf,                    /* evaluating #if and #elif expressions */
+    phaseWrite,                 /* writing lines of output */
+    phaseCount
+};
+
+/* The hardware events that are counted.
+ */
+enum perfevent {
+    eventCycles = 0,            /* CPU cycles */
+    eventInstructions,          /* instructions retired */
+    eventBranchMisses,          /* mispredicted branches */
+    eventL1Misses,              /* level-one data cache read misses */
+    eventLLCMisses,             /* last-level cache read misses */
+    eventCount
+};
+
+/* Opens and starts the counters for the calling thread. The return
+ * value is false if none of the events can be counted, in which case
+ * errno indicates why.
+ */
+extern int startperfcounters(void);
+
+/* Stops the counters, attributing the remaining counts to the current
+ * phase. The totals remain available afterwards.
+ */
+extern void stopperfcounters(void);
+
+/* Changes the current phase, and returns the previous one.
+ */
+extern int setperfphase(int phase);
+
+/* Adds to the number of bytes of input processed.
+ */
+extern void addperfinput(size_t size);
+
+/* Returns the number of bytes of input processed.
+ */
+extern unsigned long long getperfinput(void);
+
+/* Retrieves the count of an event for a phase, or for all phases
+ * together if phase is phaseCount. The return value is false if the
+ * event could not be counted.
+ */
+extern int getperfcount(int phase, int event, unsigned long long *count);
+
+/* Returns short names for the phases and events.
+ */
+extern char const *getperfphasename(int phase);
+extern char const *getperfeventname(int event);
+
+#endif
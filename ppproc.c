@@ -4,6 +4,11 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
+#ifndef NO_THREADS
+#include <pthread.h>
+#endif
+#define MEMTAG memPpproc
 #include "gen.h"
 #include "types.h"
 #include "error.h"
@@ -11,11 +16,35 @@
 #include "mstr.h"
 #include "clexer.h"
 #include "exptree.h"
+#include "udiff.h"
+#include "deps.h"
+#include "perfctr.h"
+#include "probes.h"
 #include "ppproc.h"
 
-/* Maximum nesting level of #if statements.
+/* The smallest input that is split into chunks for parallel lexing,
+ * and the smallest size of a chunk.
  */
-#define STACK_SIZE 1024
+#define PARALLEL_MINSIZE        (1024 * 1024)
+#define CHUNK_MINSIZE           (256 * 1024)
+
+/* The lock around the queue of chunks. When built with NO_THREADS,
+ * only one job is ever run, and so no lock is needed.
+ */
+#ifdef NO_THREADS
+#define lockqueue(q)            ((void)0)
+#define unlockqueue(q)          ((void)0)
+#else
+#define lockqueue(q)            pthread_mutex_lock(&(q)->lock)
+#define unlockqueue(q)          pthread_mutex_unlock(&(q)->lock)
+#endif
+
+/* The identifying bytes at the start of an index file, and the flags
+ * recording the settings that the index depends on.
+ */
+#define INDEX_MAGIC             "CPPPIDX\002"
+#define INDEX_TRIGRAPHS         0x0001
+#define INDEX_MULTICHARS        0x0002
 
 /* State flags tracking the current state of ppproc.
  */
@@ -28,6 +57,13 @@
 #define F_IfModify      0x0040          /* modified #if expression */
 #define F_ElseModify    0x0080          /* modified #elif expression */
 
+/* Flags summarizing the sections of a group that precede the current
+ * one.
+ */
+#define S_AllOurs       0x0001          /* all are guarded by our symbols */
+#define S_ElseModify    0x0002          /* an #elif was changed to #else */
+#define S_Modify        0x0004          /* an #elif expression was modified */
+
 /* Return codes for the seqif() function.
  */
 enum status
@@ -35,6 +71,17 @@ enum status
     statError, statDefined, statUndefined, statPartDefined, statUnaffected
 }; 
 
+/* The state of a group of sections, beginning with an #if statement
+ * and continuing through any #elif statements to the #endif. The
+ * flags of the earlier sections are summarized as each new section
+ * begins, so that they never need to be revisited.
+ */
+typedef struct ifgroup {
+    int         flags;                  /* state flags for current section */
+    int         first;                  /* flags of the #if, after an #elif */
+    int         earlier;                /* summary of the earlier sections */
+} ifgroup;
+
 /* The partial preprocessor.
  */
 struct ppproc {
@@ -42,16 +89,128 @@ struct ppproc {
     symset const *defs;                 /* list of defined symbols */
     symset const *undefs;               /* list of undefined symbols */
     mstr       *line;                   /* the current line of input */
+    udiff      *diff;                   /* the edit script, if requested */
+    FILE       *index;                  /* the index for the next file */
+    textsink    sink;                   /* where the output is sent */
+    void       *sinkdata;               /* the data passed to sink */
+    char const *feedname;               /* the name of the input being fed */
+    char       *pending;                /* fed input not yet processed */
+    size_t      pendingsize;            /* the amount of input in pending */
+    size_t      pendingalloc;           /* the size of the pending buffer */
+    size_t      pendingscan;            /* how much of pending is known to
+                                           hold no complete line */
+    int         scanback[2];            /* the last two characters scanned */
+    unsigned long feedline;             /* line number of the pending input */
+    int         feedfailed;             /* true if the output has failed */
     int         copy;                   /* true if input is going to output */
     int         absorb;                 /* true if input is being suppressed */
+    int         edited;                 /* true if the line has been altered */
     int         level;                  /* current nesting level */
-    int         stack[STACK_SIZE];      /* state flags for each level */
+    ifgroup    *groups;                 /* the state of each level */
+    int         allocated;              /* the size of the groups array */
+};
+
+/* A source of input text: either a file, or a buffer in memory.
+ */
+typedef struct linesource {
+    FILE       *fp;                     /* the input file, or NULL */
+    char const *buf;                    /* the input buffer, if fp is NULL */
+    size_t      pos;                    /* the current position in buf */
+    size_t      end;                    /* the end of the input in buf */
+    size_t      linestart;              /* where the last line began in buf */
+} linesource;
+
+/* A line that may need to be processed in full when a chunk is
+ * replayed, either because it contains a preprocessor statement or
+ * because it contains an error that needs to be reported. The
+ * position of the statement's expression is relative to the line
+ * after phase two of translation.
+ */
+typedef struct specline {
+    size_t      offset;                 /* the line's position in the input */
+    size_t      size;                   /* the line's length in the input */
+    unsigned long lineno;               /* line number relative to the chunk */
+    clexerstate before;                 /* lexer state at the line's start */
+    clexerstate after;                  /* lexer state at the line's end */
+    enum ppcmd  cmd;                    /* the preprocessor statement, if any */
+    int         errors;                 /* the number of errors in the line */
+} specline;
+
+/* The results of lexing a chunk from a presumed starting state.
+ */
+typedef struct speculation {
+    clexerstate start;                  /* the presumed starting state */
+    clexerstate end;                    /* the resulting state at the end */
+    specline   *lines;                  /* the lines needing processing */
+    int         count;                  /* the number of such lines */
+    int         allocated;              /* the size of the lines array */
+} speculation;
+
+/* A section of the input, beginning and ending on line boundaries,
+ * that is lexed independently of the others.
+ */
+typedef struct chunk {
+    size_t      begin;                  /* the chunk's start in the input */
+    size_t      end;                    /* the end of the chunk */
+    unsigned long linecount;            /* the number of lines it contains */
+    speculation spec[2];                /* presuming outside, inside comment */
+} chunk;
+
+/* The list of chunks that the threads take turns claiming.
+ */
+typedef struct chunkqueue {
+    char const *buf;                    /* the input */
+    chunk      *chunks;                 /* the chunks of the input */
+    int         count;                  /* the number of chunks */
+    int         next;                   /* the next chunk to be claimed */
+#ifndef NO_THREADS
+    pthread_mutex_t lock;               /* protects next */
+#endif
+    allocator const *alloc;             /* the allocator for every thread */
+} chunkqueue;
+
+/* The settings of a symbol in a variant.
+ */
+#define VAR_UNSEEN              '?'     /* not yet tested by any statement */
+#define VAR_DEFINED             'D'     /* defined, as if by -D */
+#define VAR_UNDEFINED           'U'     /* undefined, as if by -U */
+#define VAR_UNSPECIFIED         '-'     /* neither */
+
+/* A combination of symbol settings being followed through the input,
+ * standing in for all of the combinations that are known to produce
+ * the same output.
+ */
+typedef struct variant {
+    ppproc     *ppp;                    /* the preprocessor state */
+    symset     *defs;                   /* the symbols that are defined */
+    symset     *undefs;                 /* the symbols that are undefined */
+    char       *settings;               /* the setting of each symbol */
+    double      weight;                 /* how many combinations it covers */
+    contentkey  hash;                   /* the key of the output so far */
+} variant;
+
+/* The results of analyzing the variant outputs of an input.
+ */
+struct varset {
+    char       *buf;                    /* the input */
+    size_t      size;                   /* the size of the input */
+    symset const *defs;                 /* defined in every variant */
+    symset const *undefs;               /* undefined in every variant */
+    char      **symbols;                /* the names of the symbols */
+    int         symbolcount;            /* how many symbols there are */
+    variant    *variants;               /* the variants being followed */
+    int         count;                  /* how many variants there are */
+    int         allocated;              /* the size of the variants array */
 };
 
 /* This global flag controls trigraph handling.
  */
 static int trigraphsenabled = FALSE;
 
+/* The number of threads to use for lexing large inputs.
+ */
+static int jobcount = 1;
+
 /* Allocates a partial preprocessor object.
  */
 ppproc *initppproc(symset const *defs, symset const *undefs)
@@ -63,6 +222,17 @@ ppproc *initppproc(symset const *defs, symset const *undefs)
     ppp->defs = defs;
     ppp->undefs = undefs;
     ppp->line = initmstr();
+    ppp->diff = NULL;
+    ppp->index = NULL;
+    ppp->sink = writetofile;
+    ppp->sinkdata = stdout;
+    ppp->feedname = NULL;
+    ppp->pending = NULL;
+    ppp->pendingsize = 0;
+    ppp->pendingalloc = 0;
+    ppp->pendingscan = 0;
+    ppp->groups = NULL;
+    ppp->allocated = 0;
     return ppp;
 }
 
@@ -72,9 +242,26 @@ void freeppproc(ppproc *ppp)
 {
     freeclexer(ppp->cl);
     freemstr(ppp->line);
+    if (ppp->diff)
+        freeudiff(ppp->diff);
+    deallocate(ppp->pending);
+    deallocate(ppp->groups);
     deallocate(ppp);
 }
 
+/* Select between outputting the processed file and outputting a
+ * unified diff of the changes.
+ */
+void outputedits(ppproc *ppp, int flag)
+{
+    if (flag && !ppp->diff) {
+        ppp->diff = initudiff();
+    } else if (!flag && ppp->diff) {
+        freeudiff(ppp->diff);
+        ppp->diff = NULL;
+    }
+}
+
 /* Enable and disable trigraph handling.
  */
 void enabletrigraphs(int flag)
@@ -82,6 +269,26 @@ void enabletrigraphs(int flag)
     trigraphsenabled = flag;
 }
 
+/* Returns the current setting for trigraph handling.
+ */
+int trigraphsenabledp(void)
+{
+    return trigraphsenabled;
+}
+
+/* Set the number of threads to use. Without thread support, the
+ * count is always one.
+ */
+void setjobcount(int count)
+{
+#ifdef NO_THREADS
+    (void)count;
+    jobcount = 1;
+#else
+    jobcount = count > 0 ? count : 1;
+#endif
+}
+
 /* Set the state appropriate for the beginning of a file.
  */
 static void beginfile(ppproc *ppp)
@@ -101,6 +308,109 @@ static void endfile(ppproc *ppp)
     erasemstr(ppp->line);
 }
 
+/* Stop processing the current file before reaching its end, without
+ * reporting unclosed sections.
+ */
+static void abandonfile(ppproc *ppp)
+{
+    abandonstream(ppp->cl);
+    ppp->level = -1;
+    erasemstr(ppp->line);
+}
+
+/* Applies an edit to the current line of input, and notes that the
+ * line has been altered.
+ */
+static char const *editline(ppproc *ppp, char const *old, int oldlen,
+                            char const *new, int newlen)
+{
+    ppp->edited = TRUE;
+    return editmstr(ppp->line, old, oldlen, new, newlen);
+}
+
+/* Begins a new group of sections at the next nesting level, with the
+ * given state flags for its first section.
+ */
+static void pushgroup(ppproc *ppp, int flags)
+{
+    ifgroup *g;
+
+    if (++ppp->level == ppp->allocated) {
+        ppp->allocated = ppp->allocated ? 2 * ppp->allocated : 64;
+        ppp->groups = reallocate(ppp->groups,
+                                 ppp->allocated * sizeof *ppp->groups);
+    }
+    g = &ppp->groups[ppp->level];
+    g->flags = flags;
+    g->first = 0;
+    g->earlier = S_AllOurs;
+}
+
+/* Begins the next section of the current group, folding the state
+ * flags of the section being left into the group's summary.
+ */
+static void nextsection(ppproc *ppp, int flags)
+{
+    ifgroup *g;
+
+    g = &ppp->groups[ppp->level];
+    if (!(g->flags & F_Elif))
+        g->first = g->flags;
+    if (!(g->flags & F_Ours))
+        g->earlier &= ~S_AllOurs;
+    if (g->flags & F_ElseModify)
+        g->earlier |= S_ElseModify;
+    if (g->flags & (F_IfModify | F_ElseModify))
+        g->earlier |= S_Modify;
+    g->flags = flags;
+}
+
+/* Makes one preprocessor's nesting state a copy of another's.
+ */
+static void copygroups(ppproc *to, ppproc const *from)
+{
+    if (to->allocated < from->allocated) {
+        to->allocated = from->allocated;
+        to->groups = reallocate(to->groups,
+                                to->allocated * sizeof *to->groups);
+    }
+    to->copy = from->copy;
+    to->level = from->level;
+    memcpy(to->groups, from->groups, (from->level + 1) * sizeof *to->groups);
+}
+
+/* Returns true if the text of a #if expression contains any of the
+ * defined or undefined symbols. This is a quick check that allows
+ * most expressions to be passed over without being parsed. The text
+ * is scanned without regard to comments or literals, which can only
+ * cause an identifier to be looked up needlessly.
+ */
+static int mentionssymbols(ppproc const *ppp, char const *ifexp)
+{
+    char const *p;
+    int size;
+
+    for (p = ifexp ; *p ; p += size ? size : 1) {
+        size = getidentifierlength(p);
+        if (size && !isdigit(*p)
+                 && (findsymbolinset(ppp->defs, p, NULL)
+                        || findsymbolinset(ppp->undefs, p, NULL)))
+            return TRUE;
+    }
+    return FALSE;
+}
+
+/* Determines whether the identifier at id is one of the defined or
+ * undefined symbols.
+ */
+static enum status symbolstatus(ppproc const *ppp, char const *id)
+{
+    int r;
+
+    r = resolvesymbol(ppp->defs, ppp->undefs, id, NULL);
+    return r > 0 ? statDefined : r < 0 ? statUndefined : statUnaffected;
+}
+
 /* Partially preprocesses a #if expression. ifexp points to the text
  * immediately following the #if. The function seeks to the end of the
  * expression and evaluates it. The return value points to the text
@@ -110,17 +420,27 @@ static void endfile(ppproc *ppp)
  * undefined symbols, status receives statUnaffected. Otherwise the
  * expression is in a partial state, in which case status receives
  * statPartDefined, and the original string is modified so as to
- * remove the parts of the expression that have a defined state.
+ * remove the parts of the expression that have a defined state. An
+ * expression that does not mention any of the symbols is not parsed,
+ * and the rest of the line is taken to be the expression.
  */
 static char const *seqif(ppproc *ppp, char *ifexp, enum status *status)
 {
     exptree *tree;
     char const *ret;
     char *str;
-    int defined, n;
+    int defined, phase, n;
 
-    tree = initexptree();
+    phase = setperfphase(phaseIf);
     *status = statUnaffected;
+    if (!endoflinep(ppp->cl) && !mentionssymbols(ppp, ifexp)) {
+        ret = restofline(ppp->cl, ifexp);
+        PROBE1(if__skip, (int)(ret - ifexp));
+        setperfphase(phase);
+        return ret;
+    }
+
+    tree = initexptree();
 
     n = geterrormark();
     ret = parseexptree(tree, ppp->cl, ifexp);
@@ -128,22 +448,24 @@ static char const *seqif(ppproc *ppp, char *ifexp, enum status *status)
         *status = statError;
         goto quit;
     }
+    PROBE2(if__parse, getexplength(tree), getexpnodecount(tree));
 
-    n = markdefined(tree, ppp->defs, TRUE) +
-        markdefined(tree, ppp->undefs, FALSE);
+    n = markdefined(tree, ppp->defs, ppp->undefs);
     if (n) {
         *status = evaltree(tree, &defined) ? statDefined : statUndefined;
         if (!defined) {
             *status = statPartDefined;
-            str = allocate(strlen(ifexp) + 1);
+            str = allocate(unparseevaluated(tree, NULL) + 1);
             n = unparseevaluated(tree, str);
-            ret = editmstr(ppp->line, ifexp, getexplength(tree), str, n) + n;
+            ret = editline(ppp, ifexp, getexplength(tree), str, n) + n;
             deallocate(str);
         }
     }
 
   quit:
+    PROBE1(if__eval, (int)*status);
     freeexptree(tree);
+    setperfphase(phase);
     return ret;
 }
 
@@ -160,10 +482,12 @@ static void seq(ppproc *ppp)
     enum status status;
     int incomment;
     enum ppcmd id;
-    int size, n;
+    ifgroup *g;
+    int size, first;
 
     incomment = ccommentp(ppp->cl);
     ppp->absorb = FALSE;
+    ppp->edited = FALSE;
     input = beginline(ppp->cl, getmstrbuf(ppp->line));
     while (!preproclinep(ppp->cl)) {
         if (endoflinep(ppp->cl))
@@ -173,32 +497,24 @@ static void seq(ppproc *ppp)
 
     cmd = skipwhite(ppp->cl, nextchar(ppp->cl, input));
     input = getpreprocessorcmd(ppp->cl, cmd, &id);
+    status = statUnaffected;
 
     switch (id) {
       case cmdIfdef:
       case cmdIfndef:
-        if (ppp->level + 1 >= sizearray(ppp->stack)) {
-            error(errIfsTooDeep);
-            break;
-        }
-        ++ppp->level;
-        ppp->stack[ppp->level] = F_If | F_Ifdef;
+        pushgroup(ppp, F_If | F_Ifdef);
+        g = &ppp->groups[ppp->level];
         if (!ppp->copy) {
             input = restofline(ppp->cl, input);
             break;
         }
-        ppp->stack[ppp->level] |= F_Copy;
+        g->flags |= F_Copy;
         size = getidentifierlength(input);
         if (!size) {
             error(errEmptyIf);
             break;
         }
-        if (findsymbolinset(ppp->defs, input, NULL))
-            status = statDefined;
-        else if (findsymbolinset(ppp->undefs, input, NULL))
-            status = statUndefined;
-        else
-            status = statUnaffected;
+        status = symbolstatus(ppp, input);
         cmdend = nextchars(ppp->cl, input, size);
         input = skipwhite(ppp->cl, cmdend);
         if (!endoflinep(ppp->cl)) {
@@ -207,7 +523,7 @@ static void seq(ppproc *ppp)
         }
         if (status != statUnaffected) {
             ppp->absorb = TRUE;
-            ppp->stack[ppp->level] |= F_Ours;
+            g->flags |= F_Ours;
             if (id == cmdIfdef)
                 ppp->copy = status == statDefined;
             else
@@ -216,12 +532,7 @@ static void seq(ppproc *ppp)
         break;
 
       case cmdIf:
-        if (ppp->level + 1 >= sizearray(ppp->stack)) {
-            error(errIfsTooDeep);
-            break;
-        }
-        ++ppp->level;
-        ppp->stack[ppp->level] = F_If | (ppp->copy ? F_Copy : 0);
+        pushgroup(ppp, F_If | (ppp->copy ? F_Copy : 0));
         if (!ppp->copy) {
             input = restofline(ppp->cl, input);
             break;
@@ -236,83 +547,58 @@ static void seq(ppproc *ppp)
         }
         if (status == statDefined || status == statUndefined) {
             ppp->absorb = TRUE;
-            ppp->stack[ppp->level] |= F_Ours;
+            ppp->groups[ppp->level].flags |= F_Ours;
             ppp->copy = status == statDefined;
         }
         break;
 
       case cmdElse:
-        if (ppp->level < 0 || (ppp->stack[ppp->level] & F_Else)) {
+        if (ppp->level < 0 || (ppp->groups[ppp->level].flags & F_Else)) {
             error(errDanglingElse);
             break;
         }
-        ppp->stack[ppp->level] |= F_Else;
+        g = &ppp->groups[ppp->level];
+        g->flags |= F_Else;
         if (!endoflinep(ppp->cl)) {
             error(errSyntax);
             break;
         }
         cmdend = input;
-        if (ppp->stack[ppp->level] & F_Ours) {
+        if (g->flags & F_Ours) {
             ppp->copy = !ppp->copy;
-            ppp->absorb = TRUE;
-            n = ppp->level;
-            while (ppp->stack[n] & F_Elif) {
-                if (ppp->stack[n] & F_ElseModify) {
-                    ppp->absorb = TRUE;
-                    break;
-                }
-                --n;
-                if (!(ppp->stack[n] & F_Ours))
-                    ppp->absorb = FALSE;
-            }
+            ppp->absorb = (g->flags & F_ElseModify)
+                       || (g->earlier & (S_ElseModify | S_AllOurs));
         }
         break;
 
       case cmdElifdef:
       case cmdElifndef:
-        if (ppp->level < 0 || (ppp->stack[ppp->level] & F_Else)) {
+        if (ppp->level < 0 || (ppp->groups[ppp->level].flags & F_Else)) {
             error(errDanglingElse);
             break;
-        } else if (ppp->level + 1 >= sizearray(ppp->stack)) {
-            error(errIfsTooDeep);
-            break;
         }
-        if (!(ppp->stack[ppp->level] & F_Ifdef))
+        g = &ppp->groups[ppp->level];
+        if (!(g->flags & F_Ifdef))
             error(errElifdefWithIf);
-        ppp->stack[ppp->level] |= F_Else;
-        if (ppp->stack[ppp->level] & F_Ours) {
+        g->flags |= F_Else;
+        if (g->flags & F_Ours) {
             ppp->copy = !ppp->copy;
-            ppp->absorb = TRUE;
-            n = ppp->level;
-            while (ppp->stack[n] & F_Elif) {
-                if (ppp->stack[n] & F_ElseModify) {
-                    ppp->absorb = TRUE;
-                    break;
-                }
-                --n;
-                if (!(ppp->stack[n] & F_Ours))
-                    ppp->absorb = FALSE;
-            }
+            ppp->absorb = (g->flags & F_ElseModify)
+                       || (g->earlier & (S_ElseModify | S_AllOurs));
         }
-        ++ppp->level;
-        ppp->stack[ppp->level] = F_If | F_Elif | F_Ifdef;
+        nextsection(ppp, F_If | F_Elif | F_Ifdef);
         cmdend = input;
         if (!ppp->copy) {
             input = restofline(ppp->cl, input);
             break;
         }
-        ppp->stack[ppp->level] |= F_Copy;
+        g->flags |= F_Copy;
         size = getidentifierlength(input);
         if (!size) {
             error(errEmptyIf);
             break;
         }
-        if (findsymbolinset(ppp->defs, input, NULL))
-            status = statDefined;
-        else if (findsymbolinset(ppp->undefs, input, NULL))
-            status = statUndefined;
-        else
-            status = statUnaffected;
+        status = symbolstatus(ppp, input);
         cmdend = nextchars(ppp->cl, input, size);
         input = skipwhite(ppp->cl, cmdend);
         if (!endoflinep(ppp->cl)) {
@@ -321,17 +607,9 @@ static void seq(ppproc *ppp)
         }
         if (status == statUnaffected) {
             ppp->absorb = FALSE;
-            n = ppp->level;
-            while (ppp->stack[n] & F_Elif) {
-                --n;
-                if (!(ppp->stack[n] & F_Ours)) {
-                    n = -1;
-                    break;
-                }
-            }
-            if (n >= 0) {
-                editmstr(ppp->line, cmd, 2, "", 0);
-                ppp->stack[ppp->level] |= F_IfModify;
+            if (g->earlier & S_AllOurs) {
+                editline(ppp, cmd, 2, "", 0);
+                g->flags |= F_IfModify;
             }
         } else {
             if (id == cmdElifdef)
@@ -339,38 +617,28 @@ static void seq(ppproc *ppp)
             else
                 ppp->copy = status == statUndefined;
             ppp->absorb = TRUE;
-            if (ppp->copy) {
-                n = ppp->level;
-                while (ppp->stack[n] & F_Elif) {
-                    --n;
-                    if (!(ppp->stack[n] & F_Ours)) {
-                        editmstr(ppp->line, cmd, cmdend - cmd, "else", 4);
-                        ppp->stack[ppp->level] |= F_ElseModify;
-                        ppp->absorb = FALSE;
-                        break;
-                    }
-                }
+            if (ppp->copy && !(g->earlier & S_AllOurs)) {
+                editline(ppp, cmd, cmdend - cmd, "else", 4);
+                g->flags |= F_ElseModify;
+                ppp->absorb = FALSE;
             }
-            ppp->stack[ppp->level] |= F_Ours;
+            g->flags |= F_Ours;
         }
         break;
 
       case cmdElif:
-        if (ppp->level < 0 || !(ppp->stack[ppp->level] & F_If)
-                           || (ppp->stack[ppp->level] & F_Else)) {
+        if (ppp->level < 0 || !(ppp->groups[ppp->level].flags & F_If)
+                           || (ppp->groups[ppp->level].flags & F_Else)) {
             error(errDanglingElse);
             break;
-        } else if (ppp->level + 1 >= sizearray(ppp->stack)) {
-            error(errIfsTooDeep);
-            break;
         }
-        if (ppp->stack[ppp->level] & F_Ifdef)
+        g = &ppp->groups[ppp->level];
+        if (g->flags & F_Ifdef)
             error(errElifWithIfdef);
-        ppp->stack[ppp->level] |= F_Else;
-        if (ppp->stack[ppp->level] & F_Ours)
+        g->flags |= F_Else;
+        if (g->flags & F_Ours)
             ppp->copy = !ppp->copy;
-        ++ppp->level;
-        ppp->stack[ppp->level] = F_If | F_Elif | (ppp->copy ? F_Copy : 0);
+        nextsection(ppp, F_If | F_Elif | (ppp->copy ? F_Copy : 0));
         if (!ppp->copy) {
             input = restofline(ppp->cl, input);
             break;
@@ -386,32 +654,19 @@ static void seq(ppproc *ppp)
         if (status == statUndefined) {
             ppp->copy = FALSE;
             ppp->absorb = TRUE;
-            ppp->stack[ppp->level] |= F_Ours;
+            g->flags |= F_Ours;
         } else if (status == statDefined) {
             ppp->absorb = TRUE;
-            n = ppp->level;
-            while (ppp->stack[n] & F_Elif) {
-                --n;
-                if (!(ppp->stack[n] & F_Ours)) {
-                    editmstr(ppp->line, cmd, cmdend - cmd, "else", 4);
-                    ppp->stack[ppp->level] |= F_ElseModify;
-                    ppp->absorb = FALSE;
-                    break;
-                }
+            if (!(g->earlier & S_AllOurs)) {
+                editline(ppp, cmd, cmdend - cmd, "else", 4);
+                g->flags |= F_ElseModify;
+                ppp->absorb = FALSE;
             }
-            ppp->stack[ppp->level] |= F_Ours;
+            g->flags |= F_Ours;
         } else {
-            n = ppp->level;
-            while (ppp->stack[n] & F_Elif) {
-                --n;
-                if (!(ppp->stack[n] & F_Ours)) {
-                    n = -1;
-                    break;
-                }
-            }
-            if (n >= 0) {
-                editmstr(ppp->line, cmd, 2, "", 0);
-                ppp->stack[ppp->level] |= F_IfModify;
+            if (g->earlier & S_AllOurs) {
+                editline(ppp, cmd, 2, "", 0);
+                g->flags |= F_IfModify;
             }
         }
         break;
@@ -426,14 +681,12 @@ static void seq(ppproc *ppp)
             error(errSyntax);
             input = restofline(ppp->cl, input);
         }
-        ppp->absorb = TRUE;
-        for ( ; ppp->stack[ppp->level] & F_Elif ; --ppp->level) {
-            if (ppp->stack[ppp->level] & (F_IfModify | F_ElseModify))
-                ppp->absorb = FALSE;
-        }
-        if (ppp->absorb)
-            ppp->absorb = ppp->stack[ppp->level] & F_Ours;
-        ppp->copy = ppp->stack[ppp->level] & F_Copy;
+        g = &ppp->groups[ppp->level];
+        first = g->flags & F_Elif ? g->first : g->flags;
+        ppp->absorb = !(g->earlier & S_Modify)
+                   && !(g->flags & (F_IfModify | F_ElseModify))
+                   && (first & F_Ours);
+        ppp->copy = first & F_Copy;
         --ppp->level;
         break;
 
@@ -441,11 +694,21 @@ static void seq(ppproc *ppp)
         input = restofline(ppp->cl, input);
         break;
     }
+    PROBE2(directive, (int)id, (int)status);
 
     if (ppp->absorb && incomment != ccommentp(ppp->cl))
         error(errBrokenComment);
 }
 
+/* Returns the next character of input, or EOF.
+ */
+static int nextinputchar(linesource *src)
+{
+    if (src->fp)
+        return fgetc(src->fp);
+    return src->pos < src->end ? (unsigned char)src->buf[src->pos++] : EOF;
+}
+
 /* Reads the next line of source code, and applies the first two
  * phases of translation. Phase one is trigraph replacement, and phase
  * two removes backslash-newline pairs. (This code also provides an
@@ -454,20 +717,22 @@ static void seq(ppproc *ppp)
  * translation, namely preprocessing. The return value is zero if the
  * file has already reached the end or if the file can't be read from.
  */
-static int readline(ppproc *ppp, FILE *infile)
+static int readline(mstr *line, linesource *src)
 {
     char const *p;
     int replacement;
     int back2, back1, ch;
 
-    ch = fgetc(infile);
+    if (!src->fp)
+        src->linestart = src->pos;
+    ch = nextinputchar(src);
     if (ch == EOF)
         return 0;
     back2 = EOF;
     back1 = EOF;
-    erasemstr(ppp->line);
+    erasemstr(line);
     while (ch != EOF) {
-        appendmstr(ppp->line, ch);
+        appendmstr(line, ch);
         if (trigraphsenabled && back2 == '?' && back1 == '?') {
             switch (ch) {
               case '=':         replacement = '#';      break;
@@ -482,22 +747,22 @@ static int readline(ppproc *ppp, FILE *infile)
               default:          replacement = 0;        break;
             }
             if (replacement) {
-                p = getmstrbuf(ppp->line) + getmstrlen(ppp->line);
-                altermstr(ppp->line, p - 3, 3, replacement);
+                p = getmstrbuf(line) + getmstrlen(line);
+                altermstr(line, p - 3, 3, replacement);
                 ch = replacement;
                 back1 = back2 = EOF;
             }
         }
         if (back1 == '\r' && ch == '\n') {
-            p = getmstrbuf(ppp->line) + getmstrlen(ppp->line);
-            altermstr(ppp->line, p - 2, 2, '\n');
+            p = getmstrbuf(line) + getmstrlen(line);
+            altermstr(line, p - 2, 2, '\n');
             back1 = back2;
             back2 = EOF;
         }
         if (ch == '\n') {
             if (back1 == '\\') {
-                p = getmstrbuf(ppp->line) + getmstrlen(ppp->line);
-                altermstr(ppp->line, p - 2, 2, 0);
+                p = getmstrbuf(line) + getmstrlen(line);
+                altermstr(line, p - 2, 2, 0);
                 ch = back2;
                 back1 = back2 = EOF;
             } else {
@@ -506,32 +771,51 @@ static int readline(ppproc *ppp, FILE *infile)
         }
         back2 = back1;
         back1 = ch;
-        ch = fgetc(infile);
+        ch = nextinputchar(src);
     }
 
-    if (ferror(infile)) {
+    if (src->fp && ferror(src->fp)) {
         error(errFileIO);
         return 0;
     }
     return 1;
 }
 
-/* Outputs the partially preprocessed line to the output file,
- * assuming anything is left to be output. The return value is false
- * if an error occurs.
+/* Outputs the partially preprocessed line, assuming anything is left
+ * to be output. A line that was read from memory and not altered is
+ * passed to the output directly from the input buffer. The return
+ * value is false if an error occurs.
  */
-static int writeline(ppproc *ppp, FILE *outfile)
+static int writeline(ppproc *ppp, linesource const *src)
 {
+    char const *text;
     size_t size;
 
     if (!ppp->line)
         return 1;
+    if (ppp->diff) {
+        if (udiffoutput(ppp->diff,
+                        ppp->copy && !ppp->absorb ?
+                                getmstrbase(ppp->line) : NULL,
+                        getmstrbaselen(ppp->line)))
+            return 1;
+        seterrorfile(NULL);
+        error(errFileIO);
+        return 0;
+    }
     if (!ppp->copy || ppp->absorb)
         return 1;
 
-    size = getmstrbaselen(ppp->line);
+    if (!src->fp && !ppp->edited) {
+        text = src->buf + src->linestart;
+        size = src->pos - src->linestart;
+    } else {
+        text = getmstrbase(ppp->line);
+        size = getmstrbaselen(ppp->line);
+    }
     if (size) {
-        if (fwrite(getmstrbase(ppp->line), size, 1, outfile) != 1) {
+        PROBE1(output, size);
+        if (!ppp->sink(text, size, ppp->sinkdata)) {
             seterrorfile(NULL);
             error(errFileIO);
             return 0;
@@ -540,31 +824,1251 @@ static int writeline(ppproc *ppp, FILE *outfile)
     return 1;
 }
 
-/* Increments the line number count, checking for embedded line break
- * characters.
+/* Outputs a run of unaltered input lines, if the current section is
+ * being passed to the output. The return value is false if an error
+ * occurs.
  */
-static void advanceline(mstr const *line)
+static int writerange(ppproc *ppp, char const *text, size_t size)
+{
+    if (!ppp->copy || !size)
+        return 1;
+    PROBE1(output, size);
+    if (!ppp->sink(text, size, ppp->sinkdata)) {
+        seterrorfile(NULL);
+        error(errFileIO);
+        return 0;
+    }
+    return 1;
+}
+
+/* Returns the amount to increment the line number count by for the
+ * given line, checking for embedded line break characters.
+ */
+static unsigned long linesin(mstr const *line)
 {
     char const *p;
+    unsigned long n;
 
+    n = 0;
     for (p = getmstrbuf(line) - 1 ; p ; p = strchr(p + 1, '\n'))
+        ++n;
+    return n;
+}
+
+/* Increments the line number count for the given line.
+ */
+static void advanceline(mstr const *line)
+{
+    unsigned long n;
+
+    for (n = linesin(line) ; n ; --n)
         nexterrorline();
 }
 
-/* Partially preprocesses each line of infile and writes the results
- * to outfile.
+/* Partially preprocesses the line of input that was just read, and
+ * outputs the result. The return value is false if an error occurs
+ * while writing. The performance counters are left attributing counts
+ * to reading, which is what follows.
+ */
+static int processline(ppproc *ppp, linesource const *src)
+{
+    int ret;
+
+    setperfphase(phaseLine);
+    addperfinput(getmstrbaselen(ppp->line));
+    if (ppp->diff)
+        udiffinput(ppp->diff, getmstrbase(ppp->line),
+                   getmstrbaselen(ppp->line));
+    seq(ppp);
+    endline(ppp->cl);
+    setperfphase(phaseWrite);
+    ret = writeline(ppp, src);
+    setperfphase(phaseRead);
+    if (!ret)
+        return 0;
+    advanceline(ppp->line);
+    return 1;
+}
+
+/* Reads the entire contents of infile into memory. The return value
+ * is the allocated buffer, or NULL if the file could not be read.
+ */
+static char *readinput(FILE *infile, size_t *size)
+{
+    char *buf;
+    size_t allocated;
+
+    allocated = 65536;
+    buf = allocate(allocated);
+    *size = 0;
+    for (;;) {
+        *size += fread(buf + *size, 1, allocated - *size, infile);
+        if (*size < allocated)
+            break;
+        allocated *= 2;
+        buf = reallocate(buf, allocated);
+    }
+    if (ferror(infile)) {
+        error(errFileIO);
+        deallocate(buf);
+        return NULL;
+    }
+    return buf;
+}
+
+/* Returns true if the newline at the given position in buf is
+ * certain to end a line after phase two of translation, i.e. if it is
+ * not preceded by a backslash (or possibly a trigraph for one).
+ */
+static int islineend(char const *buf, size_t begin, size_t pos)
+{
+    if (pos > begin && buf[pos - 1] == '\r')
+        --pos;
+    return pos == begin || (buf[pos - 1] != '\\' && buf[pos - 1] != '/');
+}
+
+/* Divides the input into chunks on line boundaries, aiming for a few
+ * chunks per thread. The return value is the number of chunks.
+ */
+static int splitchunks(char const *buf, size_t size, chunk **pchunks)
+{
+    chunk *chunks;
+    char const *p;
+    size_t target, begin, end;
+    int count, allocated;
+
+    target = size / (jobcount * 4);
+    if (target < CHUNK_MINSIZE)
+        target = CHUNK_MINSIZE;
+    allocated = 8;
+    chunks = allocate(allocated * sizeof *chunks);
+    count = 0;
+    for (begin = 0 ; begin < size ; begin = end) {
+        end = begin + target;
+        if (end >= size) {
+            end = size;
+        } else {
+            for (;;) {
+                p = memchr(buf + end, '\n', size - end);
+                if (!p) {
+                    end = size;
+                    break;
+                }
+                end = p - buf + 1;
+                if (islineend(buf, begin, end - 1))
+                    break;
+            }
+        }
+        if (count == allocated) {
+            allocated *= 2;
+            chunks = reallocate(chunks, allocated * sizeof *chunks);
+        }
+        chunks[count].begin = begin;
+        chunks[count].end = end;
+        ++count;
+    }
+    *pchunks = chunks;
+    return count;
+}
+
+/* Lexes a chunk of input, presuming it to begin either inside or
+ * outside of a comment, and records which lines will need to be
+ * processed in full. Lines that do not contain a preprocessor
+ * statement and have no errors only need their effect on the lexer's
+ * state, which is captured by the state recorded at the next line
+ * that is recorded. Errors are counted, not reported, so this
+ * function can safely be run in parallel with itself.
+ */
+static void speculate(chunk *c, char const *buf, int incomment)
+{
+    speculation *spec;
+    specline *sl;
+    linesource src;
+    clexerstate before;
+    clexer *cl;
+    mstr *line;
+    char const *input;
+    enum ppcmd cmd;
+    unsigned long lineno;
+    size_t offset;
+    int directive;
+
+    spec = &c->spec[incomment];
+    spec->lines = NULL;
+    spec->count = 0;
+    spec->allocated = 0;
+    cl = initclexer();
+    line = initmstr();
+    presumelexerstate(cl, incomment);
+    savelexerstate(cl, &spec->start);
+    src.fp = NULL;
+    src.buf = buf;
+    src.pos = c->begin;
+    src.end = c->end;
+    lineno = 0;
+    for (;;) {
+        offset = src.pos;
+        if (!readline(line, &src))
+            break;
+        savelexerstate(cl, &before);
+        quietclexer(cl, TRUE);
+        input = beginline(cl, getmstrbuf(line));
+        while (!preproclinep(cl) && !endoflinep(cl))
+            input = nextchar(cl, input);
+        cmd = cmdNone;
+        directive = preproclinep(cl);
+        if (directive) {
+            input = skipwhite(cl, nextchar(cl, input));
+            input = getpreprocessorcmd(cl, input, &cmd);
+        }
+        restofline(cl, input);
+        endline(cl);
+        if (!directive && !getlexererrors(cl)) {
+            lineno += linesin(line);
+            continue;
+        }
+        if (spec->count == spec->allocated) {
+            spec->allocated = spec->allocated ? 2 * spec->allocated : 64;
+            spec->lines = reallocate(spec->lines,
+                                     spec->allocated * sizeof *spec->lines);
+        }
+        sl = &spec->lines[spec->count++];
+        sl->offset = offset;
+        sl->size = src.pos - offset;
+        sl->lineno = lineno;
+        sl->before = before;
+        savelexerstate(cl, &sl->after);
+        sl->cmd = cmd;
+        sl->errors = getlexererrors(cl);
+        lineno += linesin(line);
+    }
+    savelexerstate(cl, &spec->end);
+    c->linecount = lineno;
+    freemstr(line);
+    freeclexer(cl);
+}
+
+/* The body of each thread. Chunks are claimed from the queue and
+ * lexed under both presumptions until none are left. Each thread
+ * allocates from the same allocator as the thread that started them.
+ */
+static void *scanchunks(void *data)
+{
+    chunkqueue *q = data;
+    int n;
+
+    setallocator(q->alloc);
+    for (;;) {
+        lockqueue(q);
+        n = q->next++;
+        unlockqueue(q);
+        if (n >= q->count)
+            break;
+        speculate(&q->chunks[n], q->buf, FALSE);
+        speculate(&q->chunks[n], q->buf, TRUE);
+    }
+    return NULL;
+}
+
+/* Returns true if a recorded line needs to be processed in full when
+ * replayed. Statements other than conditionals, such as #define, do
+ * not affect the output, and so only lines containing errors need to
+ * be examined again.
+ */
+static int needsreplay(specline const *sl)
+{
+    switch (sl->cmd) {
+      case cmdIf:
+      case cmdIfdef:
+      case cmdIfndef:
+      case cmdElif:
+      case cmdElifdef:
+      case cmdElifndef:
+      case cmdElse:
+      case cmdEndif:
+        return TRUE;
+      default:
+        return sl->errors != 0;
+    }
+}
+
+/* Partially preprocesses a chunk of the input, using whichever of its
+ * speculations started from the lexer's actual state. Only the lines
+ * that the speculation recorded are processed; the runs of lines in
+ * between are copied or dropped as a whole. If the lexer's state
+ * should ever diverge from the speculation's (which is possible
+ * following a syntax error), or if neither speculation applies, the
+ * remainder of the chunk is processed line by line. The return value
+ * is false if an error occurs while writing.
+ */
+static int replaychunk(ppproc *ppp, char const *buf, chunk const *c,
+                       unsigned long lineno)
+{
+    speculation const *spec;
+    specline const *sl;
+    linesource src;
+    clexerstate state;
+    unsigned long linepos;
+    size_t pos;
+    int i;
+
+    savelexerstate(ppp->cl, &state);
+    if (samelexerstate(&state, &c->spec[0].start))
+        spec = &c->spec[0];
+    else if (samelexerstate(&state, &c->spec[1].start))
+        spec = &c->spec[1];
+    else
+        spec = NULL;
+
+    src.fp = NULL;
+    src.buf = buf;
+    pos = c->begin;
+    linepos = 0;
+    if (spec) {
+        for (i = 0 ; i < spec->count ; ++i) {
+            sl = &spec->lines[i];
+            if (!needsreplay(sl))
+                continue;
+            if (!writerange(ppp, buf + pos, sl->offset - pos))
+                return 0;
+            restorelexerstate(ppp->cl, &sl->before);
+            seterrorline(lineno + sl->lineno);
+            src.pos = sl->offset;
+            src.end = sl->offset + sl->size;
+            readline(ppp->line, &src);
+            if (!processline(ppp, &src))
+                return 0;
+            pos = src.end;
+            linepos = sl->lineno + linesin(ppp->line);
+            savelexerstate(ppp->cl, &state);
+            if (!samelexerstate(&state, &sl->after))
+                break;
+        }
+        if (i == spec->count) {
+            restorelexerstate(ppp->cl, &spec->end);
+            return writerange(ppp, buf + pos, c->end - pos);
+        }
+    }
+
+    seterrorline(lineno + linepos);
+    src.pos = pos;
+    src.end = c->end;
+    while (readline(ppp->line, &src))
+        if (!processline(ppp, &src))
+            return 0;
+    return 1;
+}
+
+/* Partially preprocesses an input held in memory, using multiple
+ * threads. The input is divided into chunks, and each chunk is lexed
+ * in parallel twice, once presuming that it begins inside a comment
+ * and once presuming that it does not. Then the chunks are replayed
+ * in order, which only requires processing the preprocessor
+ * statements. The output is identical to that of processing the
+ * input one line at a time.
+ */
+static void parallelpreprocess(ppproc *ppp, char const *buf, size_t size)
+{
+    chunkqueue q;
+#ifndef NO_THREADS
+    pthread_t *threads;
+    int threadcount;
+#endif
+    unsigned long lineno;
+    int n;
+
+    q.buf = buf;
+    q.count = splitchunks(buf, size, &q.chunks);
+    q.next = 0;
+    q.alloc = getallocator();
+#ifdef NO_THREADS
+    scanchunks(&q);
+#else
+    pthread_mutex_init(&q.lock, NULL);
+    threads = allocate(jobcount * sizeof *threads);
+    for (threadcount = 0 ; threadcount < jobcount - 1 ; ++threadcount)
+        if (pthread_create(&threads[threadcount], NULL, scanchunks, &q))
+            break;
+    scanchunks(&q);
+    while (threadcount--)
+        pthread_join(threads[threadcount], NULL);
+    deallocate(threads);
+    pthread_mutex_destroy(&q.lock);
+#endif
+
+    lineno = 1;
+    for (n = 0 ; n < q.count ; ++n) {
+        if (!replaychunk(ppp, buf, &q.chunks[n], lineno))
+            break;
+        lineno += q.chunks[n].linecount;
+    }
+
+    for (n = 0 ; n < q.count ; ++n) {
+        deallocate(q.chunks[n].spec[0].lines);
+        deallocate(q.chunks[n].spec[1].lines);
+    }
+    deallocate(q.chunks);
+}
+
+/* Returns the flags for the current settings that affect the lexing.
+ */
+static unsigned long indexflags(void)
+{
+    return (trigraphsenabled ? INDEX_TRIGRAPHS : 0)
+         | (multicharsallowedp() ? INDEX_MULTICHARS : 0);
+}
+
+/* Writes a 32-bit value in network byte order. The return value is
+ * false if an error occurs.
+ */
+static int putvalue(FILE *fp, unsigned long value)
+{
+    unsigned char buf[4];
+
+    buf[0] = (value >> 24) & 0xFF;
+    buf[1] = (value >> 16) & 0xFF;
+    buf[2] = (value >> 8) & 0xFF;
+    buf[3] = value & 0xFF;
+    return fwrite(buf, sizeof buf, 1, fp) == 1;
+}
+
+/* Reads a 32-bit value in network byte order. The return value is
+ * false if the file ends early.
+ */
+static int getvalue(FILE *fp, unsigned long *value)
+{
+    unsigned char buf[4];
+
+    if (fread(buf, sizeof buf, 1, fp) != 1)
+        return 0;
+    *value = ((unsigned long)buf[0] << 24) | ((unsigned long)buf[1] << 16)
+           | ((unsigned long)buf[2] << 8) | (unsigned long)buf[3];
+    return 1;
+}
+
+/* Lexes the contents of infile and writes an index of its
+ * preprocessor statements to indexfile. The index records the
+ * position and type of each statement, and the lexer's state on
+ * either side of it. Lines containing errors are recorded in the same
+ * way. None of this depends on the
+ * symbols being defined or undefined, so the same index can be
+ * applied with any set of symbols.
+ */
+int buildindex(FILE *infile, FILE *indexfile)
+{
+    specline const *sl;
+    chunk c;
+    char *buf;
+    size_t size;
+    contentkey key;
+    int ok, i;
+
+    buf = readinput(infile, &size);
+    if (!buf)
+        return 0;
+    if (size > 0xFFFFFFFFUL) {
+        deallocate(buf);
+        return 0;
+    }
+    c.begin = 0;
+    c.end = size;
+    speculate(&c, buf, FALSE);
+    initcontentkey(&key);
+    addtocontentkey(&key, buf, size);
+    deallocate(buf);
+
+    ok = fwrite(INDEX_MAGIC, 8, 1, indexfile) == 1
+      && putvalue(indexfile, indexflags())
+      && putvalue(indexfile, size)
+      && putvalue(indexfile, key.hash[0])
+      && putvalue(indexfile, key.hash[1])
+      && putvalue(indexfile, c.linecount)
+      && putvalue(indexfile, c.spec[0].end.state)
+      && putvalue(indexfile, c.spec[0].end.charquote)
+      && putvalue(indexfile, c.spec[0].count);
+    for (i = 0 ; ok && i < c.spec[0].count ; ++i) {
+        sl = &c.spec[0].lines[i];
+        ok = putvalue(indexfile, sl->offset)
+          && putvalue(indexfile, sl->size)
+          && putvalue(indexfile, sl->lineno)
+          && putvalue(indexfile, sl->before.state)
+          && putvalue(indexfile, sl->before.charquote)
+          && putvalue(indexfile, sl->after.state)
+          && putvalue(indexfile, sl->after.charquote)
+          && putvalue(indexfile, sl->cmd)
+          && putvalue(indexfile, sl->errors);
+    }
+    deallocate(c.spec[0].lines);
+    return ok;
+}
+
+/* Reads an index file into a chunk spanning the entire input. The
+ * return value is false if the index is unreadable, or if it was not
+ * built from this input with the current settings.
+ */
+static int loadindex(FILE *indexfile, char const *buf, size_t size,
+                     chunk *c)
+{
+    speculation *spec;
+    specline *sl;
+    char magic[8];
+    contentkey key;
+    unsigned long value[9];
+    unsigned long count;
+    int i, n;
+
+    if (fread(magic, sizeof magic, 1, indexfile) != 1
+                || memcmp(magic, INDEX_MAGIC, sizeof magic))
+        return 0;
+    for (n = 0 ; n < 8 ; ++n)
+        if (!getvalue(indexfile, &value[n]))
+            return 0;
+    initcontentkey(&key);
+    addtocontentkey(&key, buf, size);
+    if (value[0] != indexflags() || value[1] != size
+                                 || value[2] != key.hash[0]
+                                 || value[3] != key.hash[1])
+        return 0;
+    count = value[7];
+
+    if (count > size)
+        return 0;
+
+    c->begin = 0;
+    c->end = size;
+    c->linecount = value[4];
+    spec = &c->spec[1];
+    spec->start.state = -1;
+    spec->start.charquote = -1;
+    spec->lines = NULL;
+    spec->count = 0;
+    spec = &c->spec[0];
+    spec->start.state = 0;
+    spec->start.charquote = 0;
+    spec->end.state = (int)value[5];
+    spec->end.charquote = (int)value[6];
+    spec->count = (int)count;
+    spec->lines = allocate((count ? count : 1) * sizeof *spec->lines);
+    size = 0;
+    for (i = 0 ; i < spec->count ; ++i) {
+        for (n = 0 ; n < 9 ; ++n)
+            if (!getvalue(indexfile, &value[n]))
+                break;
+        if (n < 9 || value[0] < size || value[1] > c->end - value[0]) {
+            deallocate(spec->lines);
+            return 0;
+        }
+        sl = &spec->lines[i];
+        sl->offset = value[0];
+        sl->size = value[1];
+        sl->lineno = value[2];
+        sl->before.state = (int)value[3];
+        sl->before.charquote = (int)value[4];
+        sl->after.state = (int)value[5];
+        sl->after.charquote = (int)value[6];
+        sl->cmd = (enum ppcmd)value[7];
+        sl->errors = (int)value[8];
+        size = sl->offset + sl->size;
+    }
+    return 1;
+}
+
+/* Supplies an index to use for the next file that is partially
+ * preprocessed.
+ */
+void useindex(ppproc *ppp, FILE *indexfile)
+{
+    ppp->index = indexfile;
+}
+
+/* Partially preprocesses each line of the input and passes the
+ * results to sink. The input is either read from infile, or, if
+ * infile is NULL, taken from the size bytes at inbuf. If an edit
+ * script was requested, filename identifies the file in the output.
+ * If an index was supplied, or if multiple threads are enabled, an
+ * input file is read into memory first. With a matching index, only
+ * the lines it records are processed; otherwise large inputs are
+ * processed in parallel.
+ */
+static void preprocess(ppproc *ppp, FILE *infile, char const *inbuf,
+                       size_t insize, textsink sink, void *data,
+                       char const *filename)
+{
+    linesource src;
+    chunk c;
+    char *buf;
+    size_t size;
+
+    PROBE1(file__begin, filename);
+    beginfile(ppp);
+    ppp->sink = sink;
+    ppp->sinkdata = data;
+    if (ppp->diff)
+        beginudiff(ppp->diff, filename, sink, data);
+    seterrorline(1);
+    src.fp = infile;
+    src.buf = inbuf;
+    src.pos = 0;
+    src.end = inbuf ? insize : 0;
+    buf = NULL;
+    setperfphase(phaseRead);
+    if ((jobcount > 1 || ppp->index) && !ppp->diff) {
+        if (infile) {
+            buf = readinput(infile, &size);
+            src.fp = NULL;
+            src.buf = buf;
+            src.end = buf ? size : 0;
+        }
+        if (src.buf && ppp->index
+                    && loadindex(ppp->index, src.buf, src.end, &c)) {
+            replaychunk(ppp, src.buf, &c, 1);
+            deallocate(c.spec[0].lines);
+            src.pos = src.end;
+        } else if (src.buf && jobcount > 1 && src.end >= PARALLEL_MINSIZE) {
+            parallelpreprocess(ppp, src.buf, src.end);
+            src.pos = src.end;
+        }
+    }
+    ppp->index = NULL;
+    while (readline(ppp->line, &src))
+        if (!processline(ppp, &src))
+            break;
+    setperfphase(phaseOther);
+    deallocate(buf);
+    seterrorline(0);
+    endfile(ppp);
+    if (ppp->diff && !endudiff(ppp->diff)) {
+        seterrorfile(NULL);
+        error(errFileIO);
+    }
+    PROBE1(file__end, filename);
+}
+
+/* Partially preprocesses the contents of infile.
+ */
+void partialpreprocess(ppproc *ppp, FILE *infile, FILE *outfile,
+                       char const *filename)
+{
+    preprocess(ppp, infile, NULL, 0, writetofile, outfile, filename);
+}
+
+/* Partially preprocesses the contents of a buffer.
+ */
+void partialpreprocessbuffer(ppproc *ppp, char const *buf, size_t size,
+                             textsink sink, void *data,
+                             char const *filename)
+{
+    preprocess(ppp, NULL, buf ? buf : "", size, sink, data, filename);
+}
+
+/* Prepares to partially preprocess an input that is supplied in
+ * pieces.
+ */
+void beginfeed(ppproc *ppp, textsink sink, void *data, char const *filename)
+{
+    PROBE1(file__begin, filename);
+    beginfile(ppp);
+    ppp->sink = sink;
+    ppp->sinkdata = data;
+    if (ppp->diff)
+        beginudiff(ppp->diff, filename, sink, data);
+    ppp->index = NULL;
+    ppp->feedname = filename;
+    ppp->pendingsize = 0;
+    ppp->pendingscan = 0;
+    ppp->feedline = 1;
+    ppp->feedfailed = FALSE;
+}
+
+/* Appends fed input to the buffer of input awaiting processing.
+ */
+static void addpending(ppproc *ppp, char const *buf, size_t size)
+{
+    if (!size)
+        return;
+    if (ppp->pendingsize + size > ppp->pendingalloc) {
+        ppp->pendingalloc = ppp->pendingalloc ? 2 * ppp->pendingalloc : 256;
+        if (ppp->pendingalloc < ppp->pendingsize + size)
+            ppp->pendingalloc = ppp->pendingsize + size;
+        ppp->pending = reallocate(ppp->pending, ppp->pendingalloc);
+    }
+    memcpy(ppp->pending + ppp->pendingsize, buf, size);
+    ppp->pendingsize += size;
+}
+
+/* Returns true if the pending input holds a complete line. The input
+ * is scanned for the end of a line as readline() would find it, but
+ * without building the line. The scan resumes where the previous call
+ * left off, so that a long line fed in small pieces is only scanned
+ * once, rather than read again in full each time a newline arrives.
+ */
+static int pendinglinecomplete(ppproc *ppp)
+{
+    int back2, back1, ch;
+
+    if (!ppp->pendingscan)
+        ppp->scanback[0] = ppp->scanback[1] = EOF;
+    back2 = ppp->scanback[0];
+    back1 = ppp->scanback[1];
+    while (ppp->pendingscan < ppp->pendingsize) {
+        ch = (unsigned char)ppp->pending[ppp->pendingscan++];
+        if (trigraphsenabled && back2 == '?' && back1 == '?'
+                             && ch && strchr("=(/)'<!>-", ch)) {
+            ch = ch == '/' ? '\\' : '#';
+            back1 = back2 = EOF;
+        }
+        if (back1 == '\r' && ch == '\n') {
+            back1 = back2;
+            back2 = EOF;
+        }
+        if (ch == '\n') {
+            if (back1 != '\\') {
+                ppp->pendingscan = 0;
+                return TRUE;
+            }
+            ch = back2;
+            back1 = back2 = EOF;
+        }
+        back2 = back1;
+        back1 = ch;
+    }
+    ppp->scanback[0] = back2;
+    ppp->scanback[1] = back1;
+    return FALSE;
+}
+
+/* Processes the complete lines at the start of a buffer of fed input.
+ * A line is complete once its final newline has been read, so that
+ * any trigraphs, CRLF pairs, and line splices at the end of the buffer
+ * are handled when the rest of the line arrives. If final is true,
+ * the buffer's last line is processed regardless. The return value is
+ * the number of bytes consumed.
+ */
+static size_t feedlines(ppproc *ppp, char const *buf, size_t size, int final)
+{
+    linesource src;
+    int n;
+
+    src.fp = NULL;
+    src.buf = buf;
+    src.pos = 0;
+    src.end = size;
+    setperfphase(phaseRead);
+    while (!ppp->feedfailed && readline(ppp->line, &src)) {
+        n = getmstrlen(ppp->line);
+        if (!final && (!n || getmstrbuf(ppp->line)[n - 1] != '\n')) {
+            src.pos = src.linestart;
+            break;
+        }
+        if (!processline(ppp, &src))
+            ppp->feedfailed = TRUE;
+    }
+    setperfphase(phaseOther);
+    return src.pos;
+}
+
+/* Partially preprocesses the next piece of the input. Lines are
+ * processed directly from buf where possible, and only an incomplete
+ * line is copied for later. Since many inputs may be fed at once,
+ * the error module's file and line number are set on every call.
+ */
+int feedpreprocess(ppproc *ppp, char const *buf, size_t size)
+{
+    char const *nl;
+    size_t n;
+
+    seterrorfile(ppp->feedname);
+    seterrorline(ppp->feedline);
+    while (size && !ppp->feedfailed) {
+        if (!ppp->pendingsize) {
+            n = feedlines(ppp, buf, size, FALSE);
+            addpending(ppp, buf + n, size - n);
+            ppp->pendingscan = 0;
+            break;
+        }
+        nl = memchr(buf, '\n', size);
+        n = nl ? (size_t)(nl + 1 - buf) : size;
+        addpending(ppp, buf, n);
+        buf += n;
+        size -= n;
+        if (nl && pendinglinecomplete(ppp)) {
+            n = feedlines(ppp, ppp->pending, ppp->pendingsize, FALSE);
+            ppp->pendingsize -= n;
+            memmove(ppp->pending, ppp->pending + n, ppp->pendingsize);
+        }
+    }
+    ppp->feedline = geterrorline();
+    seterrorfile(NULL);
+    return !ppp->feedfailed;
+}
+
+/* Processes whatever remains of the fed input, and finishes the file.
+ */
+int finishpreprocess(ppproc *ppp)
+{
+    seterrorfile(ppp->feedname);
+    seterrorline(ppp->feedline);
+    if (ppp->pendingsize && !ppp->feedfailed)
+        feedlines(ppp, ppp->pending, ppp->pendingsize, TRUE);
+    ppp->pendingsize = 0;
+    seterrorline(0);
+    endfile(ppp);
+    seterrorfile(NULL);
+    if (ppp->diff && !ppp->feedfailed && !endudiff(ppp->diff)) {
+        error(errFileIO);
+        ppp->feedfailed = TRUE;
+    }
+    PROBE1(file__end, ppp->feedname);
+    return !ppp->feedfailed;
+}
+
+/* Lexes a line and, if it contains a conditional statement, finds the
+ * symbols whose definitions it tests. The return value is the number
+ * of symbols found, and ids receives an allocated array of pointers
+ * to them within the line, or NULL if there are none.
+ */
+static int getlinesymbols(clexer *cl, exptree *tree, char const *line,
+                          char const ***ids)
+{
+    char const *input;
+    enum ppcmd id;
+    int count;
+
+    *ids = NULL;
+    count = 0;
+    input = beginline(cl, line);
+    while (!preproclinep(cl) && !endoflinep(cl))
+        input = nextchar(cl, input);
+    if (preproclinep(cl)) {
+        input = skipwhite(cl, nextchar(cl, input));
+        input = getpreprocessorcmd(cl, input, &id);
+        switch (id) {
+          case cmdIfdef:
+          case cmdIfndef:
+          case cmdElifdef:
+          case cmdElifndef:
+            if (getidentifierlength(input)) {
+                *ids = allocate(sizeof **ids);
+                (*ids)[0] = input;
+                count = 1;
+            }
+            break;
+          case cmdIf:
+          case cmdElif:
+            clearexptree(tree);
+            input = parseexptree(tree, cl, input);
+            count = getidentifiers(tree, NULL, 0);
+            if (count) {
+                *ids = allocate(count * sizeof **ids);
+                getidentifiers(tree, *ids, count);
+            }
+            break;
+          default:
+            break;
+        }
+        restofline(cl, input);
+    }
+    endline(cl);
+    return count;
+}
+
+/* Records the symbols tested by each conditional statement in infile.
+ * Every statement is examined, regardless of whether or not it is
+ * inside of a section that would be removed, since a different set of
+ * symbols could cause it to be kept.
+ */
+void collectdeps(ppproc *ppp, FILE *infile, depindex *deps)
+{
+    linesource src;
+    exptree *tree;
+    char const **ids;
+    int count, n;
+
+    beginfile(ppp);
+    seterrorline(1);
+    src.fp = infile;
+    tree = initexptree();
+    while (readline(ppp->line, &src)) {
+        count = getlinesymbols(ppp->cl, tree, getmstrbuf(ppp->line), &ids);
+        for (n = 0 ; n < count ; ++n)
+            adddepsymbol(deps, ids[n]);
+        deallocate(ids);
+        advanceline(ppp->line);
+    }
+    freeexptree(tree);
+    seterrorline(0);
+    endfile(ppp);
+}
+
+/* Updates the symbol sets of a variant to match its settings. The
+ * sets start as copies of the symbols shared by every variant, less
+ * the symbols being analyzed, which are then added as the variant's
+ * settings dictate.
+ */
+static void setvariantsymbols(varset *vs, variant *v)
+{
+    int i;
+
+    freesymset(v->defs);
+    freesymset(v->undefs);
+    v->defs = initsymset();
+    v->undefs = initsymset();
+    if (vs->defs)
+        copysymbols(v->defs, vs->defs);
+    if (vs->undefs)
+        copysymbols(v->undefs, vs->undefs);
+    for (i = 0 ; i < vs->symbolcount ; ++i) {
+        removesymbolfromset(v->defs, vs->symbols[i]);
+        removesymbolfromset(v->undefs, vs->symbols[i]);
+        if (v->settings[i] == VAR_DEFINED)
+            addsymboltoset(v->defs, vs->symbols[i], 1L);
+        else if (v->settings[i] == VAR_UNDEFINED)
+            addsymboltoset(v->undefs, vs->symbols[i], 0L);
+    }
+    v->ppp->defs = v->defs;
+    v->ppp->undefs = v->undefs;
+}
+
+/* Adds a new variant to the set, with an initial preprocessor state.
+ */
+static variant *addvariant(varset *vs)
+{
+    variant *v;
+
+    if (vs->count == vs->allocated) {
+        vs->allocated = vs->allocated ? 2 * vs->allocated : 16;
+        vs->variants = reallocate(vs->variants,
+                                  vs->allocated * sizeof *vs->variants);
+    }
+    v = &vs->variants[vs->count++];
+    v->ppp = initppproc(NULL, NULL);
+    beginfile(v->ppp);
+    v->defs = NULL;
+    v->undefs = NULL;
+    v->settings = allocate(vs->symbolcount + 1);
+    memset(v->settings, VAR_UNSEEN, vs->symbolcount);
+    v->settings[vs->symbolcount] = '\0';
+    v->weight = 1;
+    initcontentkey(&v->hash);
+    return v;
+}
+
+/* Deallocates the contents of a variant.
+ */
+static void freevariant(variant *v)
+{
+    freeppproc(v->ppp);
+    freesymset(v->defs);
+    freesymset(v->undefs);
+    deallocate(v->settings);
+}
+
+/* Splits a variant on a symbol that is about to be tested for the
+ * first time. The variant becomes the one in which the symbol is
+ * unspecified, and two copies are added in which it is defined and
+ * undefined.
+ */
+static void splitvariant(varset *vs, int n, int sym)
+{
+    static char const states[] = { VAR_DEFINED, VAR_UNDEFINED };
+    variant *v, *w;
+    int i;
+
+    for (i = 0 ; i < sizearray(states) ; ++i) {
+        w = addvariant(vs);
+        v = &vs->variants[n];
+        strcpy(w->settings, v->settings);
+        w->settings[sym] = states[i];
+        w->weight = v->weight;
+        w->hash = v->hash;
+        copygroups(w->ppp, v->ppp);
+        setvariantsymbols(vs, w);
+    }
+    vs->variants[n].settings[sym] = VAR_UNSPECIFIED;
+}
+
+/* Returns true if two variants are certain to produce the same output.
+ * This is the case if their output has been the same so far, their
+ * preprocessor state is the same, and their settings are the same for
+ * every symbol that will still be tested. If final is true, the end
+ * of the input has been reached, and only the output matters.
+ */
+static int samevariant(varset const *vs, variant const *a, variant const *b,
+                       int const *lastref, int pos, int final)
+{
+    int i;
+
+    if (a->hash.size != b->hash.size || a->hash.hash[0] != b->hash.hash[0]
+                                     || a->hash.hash[1] != b->hash.hash[1])
+        return FALSE;
+    if (final)
+        return TRUE;
+    if (a->ppp->copy != b->ppp->copy || a->ppp->level != b->ppp->level)
+        return FALSE;
+    if (memcmp(a->ppp->groups, b->ppp->groups,
+               (a->ppp->level + 1) * sizeof *a->ppp->groups))
+        return FALSE;
+    for (i = 0 ; i < vs->symbolcount ; ++i)
+        if (lastref[i] >= pos && a->settings[i] != b->settings[i])
+            return FALSE;
+    return TRUE;
+}
+
+/* Combines the variants that are certain to produce the same output.
+ * Beforehand, any symbol that has not been tested and never will be
+ * is marked as unspecified, and the variant's weight is tripled to
+ * account for the three settings it stands in for.
+ */
+static void mergevariants(varset *vs, int const *lastref, int pos, int final)
+{
+    variant *v;
+    int i, j, n;
+
+    for (n = 0 ; n < vs->count ; ++n) {
+        v = &vs->variants[n];
+        for (i = 0 ; i < vs->symbolcount ; ++i) {
+            if (v->settings[i] == VAR_UNSEEN && (final || lastref[i] < pos)) {
+                v->settings[i] = VAR_UNSPECIFIED;
+                v->weight *= 3;
+            }
+        }
+    }
+    for (i = 0 ; i < vs->count ; ++i) {
+        for (j = i + 1 ; j < vs->count ; ++j) {
+            if (!samevariant(vs, &vs->variants[i], &vs->variants[j],
+                             lastref, pos, final))
+                continue;
+            vs->variants[i].weight += vs->variants[j].weight;
+            freevariant(&vs->variants[j]);
+            --vs->count;
+            memmove(&vs->variants[j], &vs->variants[j + 1],
+                    (vs->count - j) * sizeof *vs->variants);
+            --j;
+        }
+    }
+}
+
+/* Determines how the output of partially preprocessing infile varies
+ * across every combination of settings of the given symbols. Rather
+ * than processing the input once per combination, the conditional
+ * statements are replayed in a single pass, following a set of
+ * variants in parallel. A variant is only split on a symbol when a
+ * statement tests that symbol, and variants are merged as soon as
+ * they are certain to produce identical output from then on. Output
+ * is compared by hashing it. Error messages are suppressed during the
+ * analysis.
+ */
+varset *analyzevariants(FILE *infile, symset const *defs,
+                        symset const *undefs, char **symbols,
+                        int symbolcount)
+{
+    varset *vs;
+    variant *v;
+    specline const *sl;
+    linesource src;
+    chunk c;
+    clexer *cl;
+    mstr *line;
+    exptree *tree;
+    symset *listed;
+    char const **ids;
+    int *lastref, *refs, *refcount;
+    long value;
+    size_t pos;
+    int count, i, j, n;
+
+    vs = allocate(sizeof *vs);
+    vs->buf = readinput(infile, &vs->size);
+    if (!vs->buf) {
+        deallocate(vs);
+        return NULL;
+    }
+    vs->defs = defs;
+    vs->undefs = undefs;
+    vs->symbols = symbols;
+    vs->symbolcount = symbolcount;
+    vs->variants = NULL;
+    vs->count = 0;
+    vs->allocated = 0;
+    c.begin = 0;
+    c.end = vs->size;
+    speculate(&c, vs->buf, FALSE);
+
+    listed = initsymset();
+    for (i = 0 ; i < symbolcount ; ++i)
+        addsymboltoset(listed, symbols[i], i);
+    lastref = allocate((symbolcount + 1) * sizeof *lastref);
+    for (i = 0 ; i < symbolcount ; ++i)
+        lastref[i] = -1;
+    refs = allocate((c.spec[0].count * symbolcount + 1) * sizeof *refs);
+    refcount = allocate((c.spec[0].count + 1) * sizeof *refcount);
+    cl = initclexer();
+    line = initmstr();
+    tree = initexptree();
+    muteerrors(TRUE);
+    src.fp = NULL;
+    src.buf = vs->buf;
+    for (j = 0 ; j < c.spec[0].count ; ++j) {
+        sl = &c.spec[0].lines[j];
+        refcount[j] = 0;
+        if (!needsreplay(sl))
+            continue;
+        src.pos = sl->offset;
+        src.end = sl->offset + sl->size;
+        readline(line, &src);
+        restorelexerstate(cl, &sl->before);
+        count = getlinesymbols(cl, tree, getmstrbuf(line), &ids);
+        for (n = 0 ; n < count ; ++n) {
+            if (!findsymbolinset(listed, ids[n], &value))
+                continue;
+            for (i = 0 ; i < refcount[j] ; ++i)
+                if (refs[j * symbolcount + i] == value)
+                    break;
+            if (i == refcount[j]) {
+                refs[j * symbolcount + refcount[j]++] = (int)value;
+                lastref[value] = j;
+            }
+        }
+        deallocate(ids);
+    }
+    freeexptree(tree);
+    freemstr(line);
+    freeclexer(cl);
+    freesymset(listed);
+
+    v = addvariant(vs);
+    setvariantsymbols(vs, v);
+    pos = 0;
+    for (j = 0 ; j < c.spec[0].count ; ++j) {
+        sl = &c.spec[0].lines[j];
+        if (!needsreplay(sl))
+            continue;
+        for (n = 0 ; n < vs->count ; ++n)
+            if (vs->variants[n].ppp->copy)
+                addtocontentkey(&vs->variants[n].hash, vs->buf + pos,
+                                sl->offset - pos);
+        for (i = 0 ; i < refcount[j] ; ++i) {
+            count = vs->count;
+            for (n = 0 ; n < count ; ++n)
+                if (vs->variants[n].settings[refs[j * symbolcount + i]]
+                                        == VAR_UNSEEN)
+                    splitvariant(vs, n, refs[j * symbolcount + i]);
+        }
+        for (n = 0 ; n < vs->count ; ++n) {
+            v = &vs->variants[n];
+            restorelexerstate(v->ppp->cl, &sl->before);
+            src.pos = sl->offset;
+            src.end = sl->offset + sl->size;
+            readline(v->ppp->line, &src);
+            seq(v->ppp);
+            endline(v->ppp->cl);
+            if (v->ppp->copy && !v->ppp->absorb)
+                addtocontentkey(&v->hash, getmstrbase(v->ppp->line),
+                                getmstrbaselen(v->ppp->line));
+        }
+        pos = sl->offset + sl->size;
+        mergevariants(vs, lastref, j + 1, FALSE);
+    }
+    for (n = 0 ; n < vs->count ; ++n)
+        if (vs->variants[n].ppp->copy)
+            addtocontentkey(&vs->variants[n].hash, vs->buf + pos,
+                            vs->size - pos);
+    mergevariants(vs, lastref, c.spec[0].count, TRUE);
+    muteerrors(FALSE);
+
+    deallocate(refcount);
+    deallocate(refs);
+    deallocate(lastref);
+    deallocate(c.spec[0].lines);
+    return vs;
+}
+
+/* Deallocates the results of the analysis.
+ */
+void freevarset(varset *vs)
+{
+    int n;
+
+    for (n = 0 ; n < vs->count ; ++n)
+        freevariant(&vs->variants[n]);
+    deallocate(vs->variants);
+    deallocate(vs->buf);
+    deallocate(vs);
+}
+
+/* Returns the number of distinct outputs.
+ */
+int getvariantcount(varset const *vs)
+{
+    return vs->count;
+}
+
+/* Returns the settings of the symbols for a representative of one of
+ * the distinct outputs.
+ */
+char const *getvariantsettings(varset const *vs, int n)
+{
+    return vs->variants[n].settings;
+}
+
+/* Returns the number of combinations that produce one of the distinct
+ * outputs.
+ */
+double getvariantweight(varset const *vs, int n)
+{
+    return vs->variants[n].weight;
+}
+
+/* Partially preprocesses the input using the representative settings
+ * for one of the distinct outputs.
  */
-void partialpreprocess(ppproc *ppp, FILE *infile, FILE *outfile)
+void writevariant(varset const *vs, int n, FILE *outfile)
 {
+    ppproc *ppp;
+    linesource src;
+
+    ppp = initppproc(vs->variants[n].defs, vs->variants[n].undefs);
+    beginfile(ppp);
+    ppp->sink = writetofile;
+    ppp->sinkdata = outfile;
+    seterrorline(1);
+    src.fp = NULL;
+    src.buf = vs->buf;
+    src.pos = 0;
+    src.end = vs->size;
+    while (readline(ppp->line, &src))
+        if (!processline(ppp, &src))
+            break;
+    seterrorline(0);
+    endfile(ppp);
+    freeppproc(ppp);
+}
+
+/* Partially preprocesses the lines of infile, without producing any
+ * output, until reaching a line that would be altered or removed.
+ */
+int checkpreprocess(ppproc *ppp, FILE *infile)
+{
+    linesource src;
+    int altered;
+
+    altered = FALSE;
     beginfile(ppp);
     seterrorline(1);
-    while (readline(ppp, infile)) {
+    src.fp = infile;
+    while (readline(ppp->line, &src)) {
         seq(ppp);
         endline(ppp->cl);
-        if (!writeline(ppp, outfile))
+        if (!ppp->copy || ppp->absorb || ppp->edited) {
+            altered = TRUE;
             break;
+        }
         advanceline(ppp->line);
     }
     seterrorline(0);
-    endfile(ppp);
+    if (altered)
+        abandonfile(ppp);
+    else
+        endfile(ppp);
+    return altered;
 }
@@ -28,8 +28,122 @@ extern void freeppproc(ppproc *ppp);
  */
 extern void enabletrigraphs(int flag);
 
-/* Partially preprocesses infile's contents to outfile.
+/* Returns true if trigraph handling is enabled.
  */
-extern void partialpreprocess(ppproc *ppp, FILE *infile, FILE *outfile);
+extern int trigraphsenabledp(void);
+
+/* Set the number of threads to use when processing large inputs. The
+ * default is one, in which case input is processed as it is read.
+ */
+extern void setjobcount(int count);
+
+/* Select the form of the output. If flag is true, then instead of the
+ * partially preprocessed file, the output is a unified diff listing
+ * only the lines that were removed or altered. Files that are not
+ * changed produce no output at all.
+ */
+extern void outputedits(ppproc *ppp, int flag);
+
+/* Writes an index of infile's preprocessor statements to indexfile.
+ * The index does not depend on the symbols that are defined, and can
+ * be reused with any of them for as long as the file's contents are
+ * unchanged. The return value is false if an error occurs.
+ */
+extern int buildindex(FILE *infile, FILE *indexfile);
+
+/* Supplies an index, made by buildindex(), for the next file to be
+ * partially preprocessed. Only the lines recorded in the index are
+ * examined; the rest of the file is copied or removed as whole
+ * sections. If the index does not match the file's current contents,
+ * it is ignored. The index is not used when outputting edits.
+ */
+extern void useindex(ppproc *ppp, FILE *indexfile);
+
+/* Partially preprocesses infile's contents to outfile. filename is
+ * used to label the file when outputting edits, and can be NULL.
+ */
+extern void partialpreprocess(ppproc *ppp, FILE *infile, FILE *outfile,
+                              char const *filename);
+
+/* Partially preprocesses the size bytes of source code at buf, in
+ * the same manner as partialpreprocess(), passing the output to sink
+ * along with data. Runs of lines that are copied unaltered are passed
+ * as pointers into buf, so sink can keep them for as long as buf
+ * remains unchanged; any other text is only valid during the call.
+ * (Edits, when requested, are always passed as temporary text.)
+ */
+extern void partialpreprocessbuffer(ppproc *ppp, char const *buf,
+                                    size_t size, textsink sink, void *data,
+                                    char const *filename);
+
+/* Prepares to partially preprocess an input that is supplied in
+ * pieces of any size, in the manner of partialpreprocessbuffer(), with
+ * the output passed to sink along with data. The text passed to sink
+ * is only valid during the call. Each ppproc object can process one
+ * such input at a time, so inputs that are fed concurrently require
+ * separate ppproc objects.
+ */
+extern void beginfeed(ppproc *ppp, textsink sink, void *data,
+                      char const *filename);
+
+/* Supplies the next size bytes of the input, and outputs as much of
+ * the result as can be determined. Only an incomplete line at the end
+ * of buf is held back until more of the input arrives. The return
+ * value is false if an error occurs while writing.
+ */
+extern int feedpreprocess(ppproc *ppp, char const *buf, size_t size);
+
+/* Signals the end of the input, and outputs the rest of the result.
+ * The return value is false if an error occurred while writing.
+ */
+extern int finishpreprocess(ppproc *ppp);
+
+/* Records in deps the symbols that are tested by infile's conditional
+ * statements. The defined and undefined symbols are not consulted.
+ */
+extern void collectdeps(ppproc *ppp, FILE *infile, depindex *deps);
+
+/* Analyzes every combination of defining, undefining, or leaving
+ * unspecified each of the given symbols, and determines which of them
+ * produce the same output, without producing any. Every variant also
+ * has the symbols in defs and undefs, either of which can be NULL,
+ * other than the ones being analyzed. The sets and the symbols array
+ * are not copied; the caller retains ownership. The return value is
+ * NULL if infile could not be read.
+ */
+extern varset *analyzevariants(FILE *infile, symset const *defs,
+                               symset const *undefs, char **symbols,
+                               int count);
+
+/* Deallocates the results of analyzevariants().
+ */
+extern void freevarset(varset *vs);
+
+/* Returns the number of distinct outputs found by the analysis.
+ */
+extern int getvariantcount(varset const *vs);
+
+/* Returns a representative combination for the nth distinct output,
+ * as a string with one character for each symbol: 'D' for defined,
+ * 'U' for undefined, or '-' for unspecified.
+ */
+extern char const *getvariantsettings(varset const *vs, int n);
+
+/* Returns the number of combinations that produce the nth distinct
+ * output.
+ */
+extern double getvariantweight(varset const *vs, int n);
+
+/* Outputs the nth distinct output, by partially preprocessing the
+ * input with its representative combination.
+ */
+extern void writevariant(varset const *vs, int n, FILE *outfile);
+
+/* Determines whether partially preprocessing infile would alter its
+ * contents, without producing any output. Processing stops at the
+ * first line that would be altered or removed, leaving the rest of
+ * the file unread. The return value is true if such a line is found.
+ */
+extern int checkpreprocess(ppproc *ppp, FILE *infile);
 
 #endif
@@ -0,0 +1,41 @@
+/* probes.h: Copyright (C) 2022 by Brian Raiter <breadbox@muppetlabs.com>
+ * License GPLv2+: GNU GPL version 2 or later.
+ */
+#ifndef _probes_h_
+#define _probes_h_
+
+/*
+ * Static tracepoints at the boundaries of the preprocessor's main
+ * stages. When <sys/sdt.h> is available, each one is compiled into a
+ * USDT probe under the provider "cppp", which costs a single no-op
+ * instruction until a tool such as bpftrace or perf attaches to it.
+ * Otherwise, or when NO_PROBES is defined, they compile to nothing.
+ * The probes are:
+ *
+ * file__begin(filename)        a file is about to be processed
+ * file__end(filename)          a file has been processed
+ * directive(cmd, status)       a preprocessor statement was handled;
+ *                              cmd is its enum ppcmd, and status is
+ *                              how a conditional was resolved
+ * if__skip(length)             a #if expression was passed over as
+ *                              not mentioning any symbols
+ * if__parse(length, nodes)     a #if expression was parsed
+ * if__eval(status)             a #if expression was evaluated, or
+ *                              found to contain an error
+ * output(size)                 a run of text was passed to the output
+ */
+
+#if defined __has_include && !defined NO_PROBES
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define PROBE1(name, a)         DTRACE_PROBE1(cppp, name, a)
+#define PROBE2(name, a, b)      DTRACE_PROBE2(cppp, name, a, b)
+#endif
+#endif
+
+#ifndef PROBE1
+#define PROBE1(name, a)         ((void)0)
+#define PROBE2(name, a, b)      ((void)0)
+#endif
+
+#endif
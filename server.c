@@ -0,0 +1,400 @@
+/* server.c: Copyright (C) 2022 by Brian Raiter <breadbox@muppetlabs.com>
+ * License GPLv2+: GNU GPL version 2 or later.
+ */
+#ifdef __linux__
+#define _GNU_SOURCE
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "gen.h"
+#include "server.h"
+
+/* Limits on the size of a request, to guard against garbage input.
+ */
+#define MAX_FIELDS      65536
+#define MAX_FIELDSIZE   65536
+
+/* Set when the server receives a signal to terminate.
+ */
+static volatile sig_atomic_t stopping = FALSE;
+
+/* The connection of the request being handled, or -1 if no request is
+ * in progress.
+ */
+static int requestconn = -1;
+
+/* Signal handler for terminating the server.
+ */
+static void stopserver(int sig)
+{
+    (void)sig;
+    stopping = TRUE;
+}
+
+/* Initializes a socket address with the given pathname. The return
+ * value is false if the pathname is too long.
+ */
+static int makeaddress(struct sockaddr_un *addr, char const *sockname)
+{
+    memset(addr, 0, sizeof *addr);
+    addr->sun_family = AF_UNIX;
+    if (strlen(sockname) >= sizeof addr->sun_path) {
+        errno = ENAMETOOLONG;
+        return FALSE;
+    }
+    strcpy(addr->sun_path, sockname);
+    return TRUE;
+}
+
+/* Returns true if the process at the other end of a connection belongs
+ * to the same user as the server. Since each request is run with the
+ * server's privileges, in a directory of the client's choosing, no
+ * other user can be allowed to make one.
+ */
+static int peerallowed(int conn)
+{
+#ifdef __linux__
+    struct ucred cred;
+    socklen_t size;
+
+    size = sizeof cred;
+    if (getsockopt(conn, SOL_SOCKET, SO_PEERCRED, &cred, &size))
+        return FALSE;
+    return cred.uid == geteuid();
+#else
+    uid_t uid;
+    gid_t gid;
+
+    if (getpeereid(conn, &uid, &gid))
+        return FALSE;
+    return uid == geteuid();
+#endif
+}
+
+/* Reads exactly size bytes. The return value is false if the stream
+ * ends early or an error occurs.
+ */
+static int readall(int fd, void *buf, size_t size)
+{
+    char *p;
+    ssize_t n;
+
+    for (p = buf ; size ; p += n, size -= n) {
+        n = read(fd, p, size);
+        if (n < 0 && errno == EINTR)
+            n = 0;
+        else if (n <= 0)
+            return FALSE;
+    }
+    return TRUE;
+}
+
+/* Writes exactly size bytes. The return value is false if an error
+ * occurs.
+ */
+static int writeall(int fd, void const *buf, size_t size)
+{
+    char const *p;
+    ssize_t n;
+
+    for (p = buf ; size ; p += n, size -= n) {
+        n = write(fd, p, size);
+        if (n < 0 && errno == EINTR)
+            n = 0;
+        else if (n <= 0)
+            return FALSE;
+    }
+    return TRUE;
+}
+
+/* Reads a 32-bit value in network byte order.
+ */
+static int readvalue(int fd, unsigned long *value)
+{
+    unsigned char buf[4];
+
+    if (!readall(fd, buf, sizeof buf))
+        return FALSE;
+    *value = ((unsigned long)buf[0] << 24) | ((unsigned long)buf[1] << 16)
+           | ((unsigned long)buf[2] << 8) | (unsigned long)buf[3];
+    return TRUE;
+}
+
+/* Writes a 32-bit value in network byte order.
+ */
+static int writevalue(int fd, unsigned long value)
+{
+    unsigned char buf[4];
+
+    buf[0] = (value >> 24) & 0xFF;
+    buf[1] = (value >> 16) & 0xFF;
+    buf[2] = (value >> 8) & 0xFF;
+    buf[3] = value & 0xFF;
+    return writeall(fd, buf, sizeof buf);
+}
+
+/* Writes a length-prefixed string.
+ */
+static int writefield(int fd, char const *str)
+{
+    size_t size;
+
+    size = strlen(str);
+    return writevalue(fd, size) && writeall(fd, str, size);
+}
+
+/* Sends the request's field count along with the three standard file
+ * descriptors.
+ */
+static int sendheader(int sock, unsigned long count)
+{
+    union {
+        struct cmsghdr  hdr;
+        char            buf[CMSG_SPACE(3 * sizeof(int))];
+    } control;
+    struct cmsghdr *cmsg;
+    struct msghdr msg;
+    struct iovec iov;
+    unsigned char buf[4];
+    int fds[3] = { 0, 1, 2 };
+
+    buf[0] = (count >> 24) & 0xFF;
+    buf[1] = (count >> 16) & 0xFF;
+    buf[2] = (count >> 8) & 0xFF;
+    buf[3] = count & 0xFF;
+    iov.iov_base = buf;
+    iov.iov_len = sizeof buf;
+    memset(&msg, 0, sizeof msg);
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buf;
+    msg.msg_controllen = sizeof control.buf;
+    cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof fds);
+    memcpy(CMSG_DATA(cmsg), fds, sizeof fds);
+    return sendmsg(sock, &msg, 0) == (ssize_t)sizeof buf;
+}
+
+/* Receives the request's field count and the client's three standard
+ * file descriptors.
+ */
+static int receiveheader(int sock, unsigned long *count, int fds[3])
+{
+    union {
+        struct cmsghdr  hdr;
+        char            buf[CMSG_SPACE(3 * sizeof(int))];
+    } control;
+    struct cmsghdr *cmsg;
+    struct msghdr msg;
+    struct iovec iov;
+    unsigned char buf[4];
+    ssize_t n;
+
+    iov.iov_base = buf;
+    iov.iov_len = sizeof buf;
+    memset(&msg, 0, sizeof msg);
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buf;
+    msg.msg_controllen = sizeof control.buf;
+    n = recvmsg(sock, &msg, 0);
+    if (n <= 0)
+        return FALSE;
+    cmsg = CMSG_FIRSTHDR(&msg);
+    if (!cmsg || cmsg->cmsg_level != SOL_SOCKET
+              || cmsg->cmsg_type != SCM_RIGHTS
+              || cmsg->cmsg_len != CMSG_LEN(3 * sizeof(int)))
+        return FALSE;
+    memcpy(fds, CMSG_DATA(cmsg), 3 * sizeof(int));
+    if (n < (ssize_t)sizeof buf && !readall(sock, buf + n, sizeof buf - n))
+        return FALSE;
+    *count = ((unsigned long)buf[0] << 24) | ((unsigned long)buf[1] << 16)
+           | ((unsigned long)buf[2] << 8) | (unsigned long)buf[3];
+    return TRUE;
+}
+
+/* Reads a request from the client connection, takes over the client's
+ * standard streams and current directory, and runs the handler. The
+ * exit code is sent back to the client. This function is called in
+ * the forked process, and does not return.
+ */
+static void handlerequest(int conn, requesthandler handler, void *data)
+{
+    char **argv;
+    unsigned long count, size, i;
+    int fds[3];
+    int exitcode, n;
+
+    if (!receiveheader(conn, &count, fds) || count < 1 || count > MAX_FIELDS)
+        _exit(EXIT_FAILURE);
+    argv = allocate((count + 1) * sizeof *argv);
+    for (i = 0 ; i < count ; ++i) {
+        if (!readvalue(conn, &size) || size > MAX_FIELDSIZE)
+            _exit(EXIT_FAILURE);
+        argv[i] = allocate(size + 1);
+        if (!readall(conn, argv[i], size))
+            _exit(EXIT_FAILURE);
+        argv[i][size] = '\0';
+    }
+    argv[count] = NULL;
+
+    requestconn = conn;
+    for (n = 0 ; n < 3 ; ++n) {
+        dup2(fds[n], n);
+        close(fds[n]);
+    }
+    if (chdir(argv[0])) {
+        perror(argv[0]);
+        exitcode = EXIT_FAILURE;
+    } else {
+        deallocate(argv[0]);
+        argv[0] = "cppp";
+        exitcode = handler((int)count, argv, data);
+    }
+    endrequest(exitcode);
+}
+
+/* Sends the exit code of the current request to the client, and exits
+ * the forked process.
+ */
+void endrequest(int exitcode)
+{
+    fflush(NULL);
+    if (requestconn >= 0)
+        writevalue(requestconn, exitcode);
+    exit(exitcode);
+}
+
+/* Creates the socket and then loops, forking off a process to handle
+ * each connection. A socket left behind by an earlier server is
+ * replaced, but any other kind of file is left alone. The socket is
+ * created with only the owner able to connect to it, and connections
+ * from other users are refused in any case.
+ */
+int runserver(char const *sockname, requesthandler handler, void *data)
+{
+    struct sockaddr_un addr;
+    struct sigaction act;
+    struct stat st;
+    mode_t mask;
+    pid_t pid;
+    int sock, conn, ret;
+
+    if (!makeaddress(&addr, sockname))
+        return FALSE;
+    if (!lstat(sockname, &st)) {
+        if (!S_ISSOCK(st.st_mode)) {
+            errno = EEXIST;
+            return FALSE;
+        }
+        unlink(sockname);
+    }
+    sock = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (sock < 0)
+        return FALSE;
+    mask = umask(0177);
+    ret = bind(sock, (struct sockaddr*)&addr, sizeof addr);
+    umask(mask);
+    if (ret || listen(sock, SOMAXCONN)) {
+        close(sock);
+        return FALSE;
+    }
+
+    memset(&act, 0, sizeof act);
+    act.sa_handler = stopserver;
+    sigemptyset(&act.sa_mask);
+    sigaction(SIGINT, &act, NULL);
+    sigaction(SIGTERM, &act, NULL);
+    sigaction(SIGHUP, &act, NULL);
+    signal(SIGCHLD, SIG_IGN);
+
+    while (!stopping) {
+        conn = accept(sock, NULL, NULL);
+        if (conn < 0) {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            perror(sockname);
+            break;
+        }
+        if (!peerallowed(conn)) {
+            close(conn);
+            continue;
+        }
+        fflush(NULL);
+        pid = fork();
+        if (pid == 0) {
+            close(sock);
+            signal(SIGINT, SIG_DFL);
+            signal(SIGTERM, SIG_DFL);
+            signal(SIGHUP, SIG_DFL);
+            signal(SIGCHLD, SIG_DFL);
+            handlerequest(conn, handler, data);
+        } else if (pid < 0) {
+            perror("fork");
+        }
+        close(conn);
+    }
+
+    close(sock);
+    unlink(sockname);
+    return TRUE;
+}
+
+/* Connects to the server, sends the current directory and the
+ * arguments, and waits for the exit code.
+ */
+int runclient(char const *sockname, int argc, char *argv[])
+{
+    struct sockaddr_un addr;
+    char *cwd;
+    unsigned long exitcode;
+    size_t size;
+    int sock, i;
+
+    if (!makeaddress(&addr, sockname))
+        return -1;
+    sock = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (sock < 0)
+        return -1;
+    if (connect(sock, (struct sockaddr*)&addr, sizeof addr)) {
+        close(sock);
+        return -1;
+    }
+
+    size = 256;
+    cwd = allocate(size);
+    while (!getcwd(cwd, size)) {
+        if (errno != ERANGE) {
+            deallocate(cwd);
+            close(sock);
+            return -1;
+        }
+        size *= 2;
+        cwd = reallocate(cwd, size);
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+    if (!sendheader(sock, argc + 1) || !writefield(sock, cwd)) {
+        deallocate(cwd);
+        close(sock);
+        return -1;
+    }
+    deallocate(cwd);
+    for (i = 0 ; i < argc ; ++i)
+        if (!writefield(sock, argv[i]))
+            break;
+    if (i < argc || !readvalue(sock, &exitcode))
+        exitcode = EXIT_FAILURE;
+    close(sock);
+    return (int)exitcode;
+}
@@ -0,0 +1,51 @@
+/* server.h: Copyright (C) 2022 by Brian Raiter <breadbox@muppetlabs.com>
+ * License GPLv2+: GNU GPL version 2 or later.
+ */
+#ifndef _server_h_
+#define _server_h_
+
+/*
+ * The server listens on a Unix-domain socket and runs requests sent
+ * by the client, so that a configuration only needs to be loaded
+ * once. Each request is handled in a forked copy of the server, which
+ * inherits the already-initialized objects. The client passes along
+ * its standard input, output, and error streams, so the request
+ * behaves exactly like a normal invocation.
+ *
+ * A request is sent as a sequence of 32-bit lengths in network byte
+ * order: first the number of fields that follow, and then each field
+ * as a length followed by that many bytes. The first field is the
+ * client's current directory, and the rest are its command-line
+ * arguments. The three file descriptors accompany the first message.
+ * The reply is the request's exit code, also as a 32-bit value.
+ */
+
+/* The function that the server calls to handle a request, in the
+ * context of the forked process. argc and argv hold the client's
+ * arguments, with argv[0] containing the program name. The return
+ * value is the exit code to send back to the client.
+ */
+typedef int (*requesthandler)(int argc, char *argv[], void *data);
+
+/* Listens for requests on the named socket, passing each one to
+ * handler along with data, until the server receives a signal to
+ * terminate. The return value is false if the socket could not be
+ * created.
+ */
+extern int runserver(char const *sockname, requesthandler handler,
+                     void *data);
+
+/* Ends the request being handled, sending exitcode to the client, and
+ * exits the forked process. A handler can call this instead of exit()
+ * when it has to stop early.
+ */
+extern void endrequest(int exitcode);
+
+/* Sends a request consisting of the given command-line arguments to
+ * the server listening on the named socket, and waits for it to
+ * complete. The return value is the request's exit code, or -1 if the
+ * server could not be contacted.
+ */
+extern int runclient(char const *sockname, int argc, char *argv[]);
+
+#endif
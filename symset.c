@@ -1,9 +1,11 @@
 /* symset.c: Copyright (C) 2011-2022 by Brian Raiter <breadbox@muppetlabs.com>
  * License GPLv2+: GNU GPL version 2 or later.
  */
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#define MEMTAG memSymset
 #include "gen.h"
 #include "types.h"
 #include "symset.h"
@@ -14,9 +16,43 @@
  * majority of symbol sets will have a size of zero or one, and will
  * almost never exceed three, and that symbol lookups are not inside
  * the program's inner loops, even hash tables are overkill here.
+ * The exception is a set that is built into a specialized program
+ * (see writesymsettable() below), which can be of any size, and which
+ * is therefore laid out in advance as a perfect hash table.
  */
 
+/* Symbols can also be given as glob patterns, in which an asterisk
+ * matches any run of characters and a question mark matches any one
+ * character. The patterns of a set are merged into a trie, so that an
+ * identifier is matched against all of them in a single pass over its
+ * characters. Wildcards in the trie are followed as in an NFA, so each
+ * character costs time in proportion to the number of nodes still in
+ * play. Without wildcards that is a single path, and a trailing
+ * asterisk only adds its own node, so prefix patterns cost the same
+ * however many there are, apart from clearing one bit per trie node at
+ * the start of each lookup. But every asterisk node that is reached
+ * stays in play, so with patterns such as *FOO* the cost can grow with
+ * the number of patterns whose leading parts the identifier matches.
+ */
+
+/* The number of trie nodes that can be in play before the lists that
+ * track them need to be allocated.
+ */
+#define LOCALSTATES 32
+
+/* The number of trie nodes that can be marked as in play before the
+ * bitmap that marks them needs to be allocated.
+ */
+#define LOCALMARKS 2048
+
+/* The most seeds that are tried for a bucket of the perfect hash table
+ * before the table is enlarged.
+ */
+#define MAXSEED 65536UL
+
 typedef struct sym sym;
+typedef struct patnode patnode;
+typedef struct stateset stateset;
 
 /* A preprocessor symbol.
  */
@@ -25,12 +61,41 @@ struct sym {
     long        value;          /* the symbol's value */
 };
 
+/* A node in the trie of symbol patterns. The root is node zero.
+ */
+struct patnode {
+    int         ch;             /* the character leading to this node */
+    int         child;          /* the first child node, or -1 */
+    int         sibling;        /* the next sibling node, or -1 */
+    int         terminal;       /* true if a pattern ends at this node */
+    int         literals;       /* the non-wildcard characters leading here */
+    long        value;          /* the value of the pattern ending here */
+};
+
 /* An unordered collection of symbols.
  */
 struct symset {
     sym        *syms;           /* an array of symbols */
     int         allocated;      /* how many entries are allocated */
     int         size;           /* how many entries are currently stored */
+    symtable const *table;      /* a fixed table of more symbols, or NULL */
+    sym        *pats;           /* an array of symbol patterns */
+    int         patallocated;   /* how many patterns are allocated */
+    int         patcount;       /* how many patterns are currently stored */
+    patnode    *nodes;          /* the trie of patterns */
+    int         nodeallocated;  /* how many nodes are allocated */
+    int         nodecount;      /* how many nodes are in use */
+};
+
+/* The trie nodes in play while matching an identifier.
+ */
+struct stateset {
+    int        *nodes;          /* the list of nodes */
+    int         count;          /* how many nodes are listed */
+    int         allocated;      /* how many nodes the list can hold */
+    int         local[LOCALSTATES];     /* the list's initial storage */
+    unsigned char *marks;       /* a bit for each trie node in the list */
+    unsigned char localmarks[LOCALMARKS / 8];   /* the bitmap's storage */
 };
 
 /* Allocate a new symset.
@@ -43,6 +108,28 @@ symset *initsymset(void)
     set->syms = allocate(sizeof *set->syms);
     set->allocated = 1;
     set->size = 0;
+    set->table = NULL;
+    set->pats = NULL;
+    set->patallocated = 0;
+    set->patcount = 0;
+    set->nodes = NULL;
+    set->nodeallocated = 0;
+    set->nodecount = 0;
+    return set;
+}
+
+/* Allocate a new symset that refers to a fixed table of symbols. The
+ * table's patterns are added to the set's trie.
+ */
+symset *initsymsetfromtable(symtable const *table)
+{
+    symset *set;
+    int i;
+
+    set = initsymset();
+    set->table = table;
+    for (i = 0 ; i < table->patterncount ; ++i)
+        addpatterntoset(set, table->patterns[i], table->patternvalues[i]);
     return set;
 }
 
@@ -52,6 +139,8 @@ void freesymset(symset *set)
 {
     if (set) {
         deallocate(set->syms);
+        deallocate(set->pats);
+        deallocate(set->nodes);
         deallocate(set);
     }
 }
@@ -89,22 +178,321 @@ static int idcmp(char const *a, char const *b)
     }
 }
 
-/* Retrieve the value of a symbol.
+/* Hashes an identifier with a seed. This is FNV-1a followed by a
+ * final mixing step, so that the low bits, which select a bucket or a
+ * slot, depend on every character. The result is the same everywhere
+ * that a long has at least 32 bits, as the tables written by one
+ * program are compiled into another.
  */
-int findsymbolinset(symset const *set, char const *id, long *value)
+static unsigned long hashid(char const *id, unsigned long seed)
 {
+    unsigned long h;
     int i;
 
-    if (set) {
-        for (i = 0 ; i < set->size ; ++i) {
-            if (!idcmp(set->syms[i].id, id)) {
-                if (value)
-                    *value = set->syms[i].value;
-                return TRUE;
+    h = (2166136261UL ^ seed) & 0xFFFFFFFFUL;
+    for (i = 0 ; _issym(id[i]) ; ++i)
+        h = ((h ^ (unsigned char)id[i]) * 16777619UL) & 0xFFFFFFFFUL;
+    h ^= h >> 16;
+    h = (h * 0x45D9F3BUL) & 0xFFFFFFFFUL;
+    h ^= h >> 16;
+    return h;
+}
+
+/* Returns the slot of a fixed table that would hold the given symbol.
+ */
+static unsigned long tableslot(symtable const *table, char const *id)
+{
+    unsigned long bucket;
+
+    bucket = hashid(id, 0) & table->bucketmask;
+    return hashid(id, table->seeds[bucket]) & table->slotmask;
+}
+
+/* Returns the length of a pattern, which unlike an identifier can
+ * contain wildcards.
+ */
+static int patternlength(char const *pattern)
+{
+    int n;
+
+    for (n = 0 ; _issym(pattern[n]) || pattern[n] == '*'
+                                    || pattern[n] == '?' ; ++n) ;
+    return n;
+}
+
+/* Returns the child of a trie node that is reached by the given
+ * character, or -1 if there is none.
+ */
+static int findchild(patnode const *nodes, int node, int ch)
+{
+    int n;
+
+    for (n = nodes[node].child ; n >= 0 ; n = nodes[n].sibling)
+        if (nodes[n].ch == ch)
+            return n;
+    return -1;
+}
+
+/* Add a pattern to a set, creating the trie if necessary. If the
+ * pattern is already present, only its value is changed.
+ */
+void addpatterntoset(symset *set, char const *pattern, long value)
+{
+    int size, node, next, i;
+
+    size = patternlength(pattern);
+    if (!set->nodes) {
+        set->nodeallocated = 16;
+        set->nodes = allocate(set->nodeallocated * sizeof *set->nodes);
+        set->nodes[0].ch = 0;
+        set->nodes[0].child = -1;
+        set->nodes[0].sibling = -1;
+        set->nodes[0].terminal = FALSE;
+        set->nodes[0].literals = 0;
+        set->nodes[0].value = 0;
+        set->nodecount = 1;
+    }
+    node = 0;
+    for (i = 0 ; i < size ; ++i) {
+        next = findchild(set->nodes, node, pattern[i]);
+        if (next < 0) {
+            if (set->nodecount == set->nodeallocated) {
+                set->nodeallocated *= 2;
+                set->nodes = reallocate(set->nodes,
+                                set->nodeallocated * sizeof *set->nodes);
             }
+            next = set->nodecount++;
+            set->nodes[next].ch = pattern[i];
+            set->nodes[next].child = -1;
+            set->nodes[next].sibling = set->nodes[node].child;
+            set->nodes[next].terminal = FALSE;
+            set->nodes[next].literals = set->nodes[node].literals
+                        + (pattern[i] != '*' && pattern[i] != '?');
+            set->nodes[next].value = 0;
+            set->nodes[node].child = next;
         }
+        node = next;
     }
-    return FALSE;
+    set->nodes[node].value = value;
+    if (set->nodes[node].terminal) {
+        for (i = 0 ; i < set->patcount ; ++i)
+            if (patternlength(set->pats[i].id) == size
+                        && !memcmp(set->pats[i].id, pattern, size))
+                set->pats[i].value = value;
+        return;
+    }
+    set->nodes[node].terminal = TRUE;
+    if (set->patcount == set->patallocated) {
+        set->patallocated = set->patallocated ? 2 * set->patallocated : 4;
+        set->pats = reallocate(set->pats,
+                               set->patallocated * sizeof *set->pats);
+    }
+    set->pats[set->patcount].id = pattern;
+    set->pats[set->patcount].value = value;
+    ++set->patcount;
+}
+
+/* Remove a pattern from a set. Its nodes are left in the trie, as they
+ * no longer lead to a match.
+ */
+int removepatternfromset(symset *set, char const *pattern)
+{
+    int size, node, i;
+
+    if (!set || !set->nodes)
+        return FALSE;
+    size = patternlength(pattern);
+    node = 0;
+    for (i = 0 ; i < size && node >= 0 ; ++i)
+        node = findchild(set->nodes, node, pattern[i]);
+    if (node < 0 || !set->nodes[node].terminal)
+        return FALSE;
+    set->nodes[node].terminal = FALSE;
+    for (i = 0 ; i < set->patcount ; ++i) {
+        if (patternlength(set->pats[i].id) == size
+                    && !memcmp(set->pats[i].id, pattern, size)) {
+            set->pats[i] = set->pats[set->patcount - 1];
+            --set->patcount;
+            break;
+        }
+    }
+    return TRUE;
+}
+
+/* Prepares an empty list of nodes in play for a trie of the given
+ * size.
+ */
+static void initstates(stateset *states, int nodecount)
+{
+    states->nodes = states->local;
+    states->count = 0;
+    states->allocated = LOCALSTATES;
+    if (nodecount <= LOCALMARKS)
+        states->marks = states->localmarks;
+    else
+        states->marks = allocate((nodecount + 7) / 8);
+    memset(states->marks, 0, (nodecount + 7) / 8);
+}
+
+/* Empties a list of nodes in play. Only the bits of the listed nodes
+ * need to be cleared.
+ */
+static void clearstates(stateset *states)
+{
+    int i;
+
+    for (i = 0 ; i < states->count ; ++i)
+        states->marks[states->nodes[i] / 8] = 0;
+    states->count = 0;
+}
+
+/* Deallocates a list of nodes in play.
+ */
+static void freestates(stateset *states)
+{
+    if (states->nodes != states->local)
+        deallocate(states->nodes);
+    if (states->marks != states->localmarks)
+        deallocate(states->marks);
+}
+
+/* Adds a trie node to a list of nodes in play, along with the nodes
+ * that follow it through asterisks, since they can match nothing. A
+ * node already in the list has its bit set, so it is skipped without
+ * searching the list.
+ */
+static void addstate(patnode const *nodes, stateset *states, int node)
+{
+    int i;
+
+    if (states->marks[node / 8] & (1 << (node % 8)))
+        return;
+    states->marks[node / 8] |= 1 << (node % 8);
+    if (states->count == states->allocated) {
+        states->allocated *= 2;
+        if (states->nodes == states->local) {
+            states->nodes = allocate(states->allocated
+                                        * sizeof *states->nodes);
+            memcpy(states->nodes, states->local, sizeof states->local);
+        } else {
+            states->nodes = reallocate(states->nodes, states->allocated
+                                                * sizeof *states->nodes);
+        }
+    }
+    states->nodes[states->count++] = node;
+    for (i = nodes[node].child ; i >= 0 ; i = nodes[i].sibling)
+        if (nodes[i].ch == '*')
+            addstate(nodes, states, i);
+}
+
+/* Matches an identifier against a set's patterns, advancing every
+ * node in play by each character. A node reached by an asterisk stays
+ * in play for any character. When more than one pattern matches, the
+ * one with the most literal characters is chosen. The return value is
+ * one more than the chosen pattern's number of literal characters, or
+ * zero if no pattern matches. The nodes in play are tracked locally,
+ * so that the set itself is not modified.
+ */
+static int matchpatterns(symset const *set, char const *id, long *value)
+{
+    patnode const *nodes = set->nodes;
+    stateset states[2];
+    stateset *cur, *next;
+    int best, node, i, j;
+
+    initstates(&states[0], set->nodecount);
+    initstates(&states[1], set->nodecount);
+    cur = &states[0];
+    next = &states[1];
+    addstate(nodes, cur, 0);
+    for (i = 0 ; _issym(id[i]) && cur->count ; ++i) {
+        clearstates(next);
+        for (j = 0 ; j < cur->count ; ++j) {
+            node = cur->nodes[j];
+            if (nodes[node].ch == '*')
+                addstate(nodes, next, node);
+            for (node = nodes[node].child ; node >= 0
+                                          ; node = nodes[node].sibling)
+                if (nodes[node].ch == id[i] || nodes[node].ch == '?')
+                    addstate(nodes, next, node);
+        }
+        cur = cur == &states[0] ? &states[1] : &states[0];
+        next = next == &states[0] ? &states[1] : &states[0];
+    }
+    best = 0;
+    for (j = 0 ; j < cur->count ; ++j) {
+        node = cur->nodes[j];
+        if (nodes[node].terminal && nodes[node].literals + 1 > best) {
+            best = nodes[node].literals + 1;
+            if (value)
+                *value = nodes[node].value;
+        }
+    }
+    freestates(&states[0]);
+    freestates(&states[1]);
+    return best;
+}
+
+/* Looks up a symbol by name first, and then against the patterns. The
+ * return value is zero if the symbol is not matched. Otherwise it is a
+ * positive number that is larger the more specific the match: a
+ * pattern gives one more than its number of literal characters, and
+ * the name itself gives two more than its length, which is more than
+ * any pattern that matches it could have.
+ */
+static int matchsymbol(symset const *set, char const *id, long *value)
+{
+    unsigned long slot;
+    int i;
+
+    if (!set)
+        return 0;
+    if (set->table) {
+        slot = tableslot(set->table, id);
+        if (set->table->ids[slot] && !idcmp(set->table->ids[slot], id)) {
+            if (value)
+                *value = set->table->values[slot];
+            return patternlength(id) + 2;
+        }
+    }
+    for (i = 0 ; i < set->size ; ++i) {
+        if (!idcmp(set->syms[i].id, id)) {
+            if (value)
+                *value = set->syms[i].value;
+            return patternlength(id) + 2;
+        }
+    }
+    return set->patcount ? matchpatterns(set, id, value) : 0;
+}
+
+/* Retrieve the value of a symbol.
+ */
+int findsymbolinset(symset const *set, char const *id, long *value)
+{
+    return matchsymbol(set, id, value) > 0;
+}
+
+/* Decide between the two sets by which one matches more specifically,
+ * with ties going to the defined symbols.
+ */
+int resolvesymbol(symset const *defs, symset const *undefs,
+                  char const *id, long *value)
+{
+    long v;
+    int d, u;
+
+    d = matchsymbol(defs, id, &v);
+    u = matchsymbol(undefs, id, NULL);
+    if (d && d >= u) {
+        if (value)
+            *value = v;
+        return +1;
+    } else if (u) {
+        if (value)
+            *value = 0;
+        return -1;
+    }
+    return 0;
 }
 
 /* Remove a symbol from a set.
@@ -124,3 +512,230 @@ int removesymbolfromset(symset *set, char const *id)
     }
     return FALSE;
 }
+
+/* Append the symbols of one set to another.
+ */
+void copysymbols(symset *set, symset const *from)
+{
+    unsigned long slot;
+    int i;
+
+    if (from->table) {
+        for (slot = 0 ; slot <= from->table->slotmask ; ++slot)
+            if (from->table->ids[slot])
+                addsymboltoset(set, from->table->ids[slot],
+                               from->table->values[slot]);
+    }
+    for (i = 0 ; i < from->size ; ++i)
+        addsymboltoset(set, from->syms[i].id, from->syms[i].value);
+    for (i = 0 ; i < from->patcount ; ++i)
+        addpatterntoset(set, from->pats[i].id, from->pats[i].value);
+}
+
+/* Adds the key of one symbol's name, or pattern, and value to a
+ * running total.
+ */
+static void addsymtokey(contentkey *key, char const *id, long value)
+{
+    contentkey sym;
+    char buf[32];
+    int n;
+
+    initcontentkey(&sym);
+    n = patternlength(id);
+    addtocontentkey(&sym, id, n);
+    n = sprintf(buf, "=%ld", value);
+    addtocontentkey(&sym, buf, n);
+    key->size += sym.size;
+    key->hash[0] = (key->hash[0] + sym.hash[0]) & 0xFFFFFFFFUL;
+    key->hash[1] = (key->hash[1] + sym.hash[1]) & 0xFFFFFFFFUL;
+}
+
+/* Computes the key of each symbol's name and value separately, and
+ * sums them, so that the order of the symbols does not matter.
+ */
+void getsymsetkey(symset const *set, contentkey *key)
+{
+    unsigned long slot;
+    int i;
+
+    key->size = 0;
+    key->hash[0] = 0;
+    key->hash[1] = 0;
+    if (set->table) {
+        for (slot = 0 ; slot <= set->table->slotmask ; ++slot)
+            if (set->table->ids[slot])
+                addsymtokey(key, set->table->ids[slot],
+                            set->table->values[slot]);
+    }
+    for (i = 0 ; i < set->size ; ++i)
+        addsymtokey(key, set->syms[i].id, set->syms[i].value);
+    for (i = 0 ; i < set->patcount ; ++i)
+        addsymtokey(key, set->pats[i].id, set->pats[i].value);
+}
+
+/* Tries to find a seed for one bucket that places each of its symbols
+ * in an unused slot. slots records the symbol in each slot, or -1.
+ * The return value is false if no seed works.
+ */
+static int placebucket(sym const *syms, int const *members, int count,
+                       int *slots, unsigned long slotmask,
+                       unsigned long *seed)
+{
+    unsigned long s, slot;
+    int i, j;
+
+    for (s = 0 ; s < MAXSEED ; ++s) {
+        for (i = 0 ; i < count ; ++i) {
+            slot = hashid(syms[members[i]].id, s) & slotmask;
+            if (slots[slot] >= 0)
+                break;
+            slots[slot] = members[i];
+        }
+        if (i == count) {
+            *seed = s;
+            return TRUE;
+        }
+        for (j = 0 ; j < i ; ++j)
+            slots[hashid(syms[members[j]].id, s) & slotmask] = -1;
+    }
+    return FALSE;
+}
+
+/* Lays out a perfect hash table for count symbols, filling in the seed
+ * for each bucket and the symbol in each slot. The buckets are placed
+ * largest first, while the most slots are still unused. The return
+ * value is false if some bucket could not be placed.
+ */
+static int layouttable(sym const *syms, int count,
+                       unsigned long slotmask, unsigned long bucketmask,
+                       unsigned long *seeds, int *slots)
+{
+    int *buckets, *sizes, *members;
+    int largest, size, n, i;
+    unsigned long b;
+    int ok;
+
+    buckets = allocate(count * sizeof *buckets + 1);
+    sizes = allocate((bucketmask + 1) * sizeof *sizes);
+    members = allocate(count * sizeof *members + 1);
+    for (b = 0 ; b <= bucketmask ; ++b) {
+        sizes[b] = 0;
+        seeds[b] = 0;
+    }
+    for (b = 0 ; b <= slotmask ; ++b)
+        slots[b] = -1;
+    largest = 0;
+    ok = TRUE;
+    for (i = 0 ; i < count ; ++i) {
+        buckets[i] = (int)(hashid(syms[i].id, 0) & bucketmask);
+        if (++sizes[buckets[i]] > largest)
+            largest = sizes[buckets[i]];
+    }
+    for (size = largest ; ok && size > 0 ; --size) {
+        for (b = 0 ; ok && b <= bucketmask ; ++b) {
+            if (sizes[b] != size)
+                continue;
+            for (i = n = 0 ; i < count ; ++i)
+                if (buckets[i] == (int)b)
+                    members[n++] = i;
+            ok = placebucket(syms, members, n, slots, slotmask, &seeds[b]);
+        }
+    }
+    deallocate(members);
+    deallocate(sizes);
+    deallocate(buckets);
+    return ok;
+}
+
+/* Lays out the symbols as a perfect hash table with at least twice as
+ * many slots as symbols, and about four symbols to a bucket, and
+ * writes out the arrays and the table that refers to them, along with
+ * the patterns, which are added to a trie when the table is used. If two
+ * symbols have the same name, only the one that findsymbolinset()
+ * would find is kept.
+ */
+int writesymsettable(symset const *set, char const *name, FILE *fp)
+{
+    sym *syms;
+    unsigned long *seeds;
+    unsigned long slotmask, bucketmask, i;
+    int *slots;
+    int count, n, j;
+
+    count = set->size;
+    if (set->table)
+        for (i = 0 ; i <= set->table->slotmask ; ++i)
+            count += set->table->ids[i] != NULL;
+    syms = allocate(count * sizeof *syms + 1);
+    count = 0;
+    if (set->table) {
+        for (i = 0 ; i <= set->table->slotmask ; ++i) {
+            if (set->table->ids[i]) {
+                syms[count].id = set->table->ids[i];
+                syms[count].value = set->table->values[i];
+                ++count;
+            }
+        }
+    }
+    for (n = 0 ; n < set->size ; ++n) {
+        for (j = 0 ; j < count ; ++j)
+            if (!idcmp(syms[j].id, set->syms[n].id))
+                break;
+        if (j == count)
+            syms[count++] = set->syms[n];
+    }
+
+    bucketmask = 0;
+    while ((bucketmask + 1) * 4 < (unsigned long)count)
+        bucketmask = bucketmask * 2 + 1;
+    slotmask = 0;
+    while (slotmask + 1 < 2 * (unsigned long)count)
+        slotmask = slotmask * 2 + 1;
+    seeds = allocate((bucketmask + 1) * sizeof *seeds);
+    for (;;) {
+        slots = allocate((slotmask + 1) * sizeof *slots);
+        if (layouttable(syms, count, slotmask, bucketmask, seeds, slots))
+            break;
+        deallocate(slots);
+        slotmask = slotmask * 2 + 1;
+    }
+
+    fprintf(fp, "static unsigned long const %s_seeds[%lu] = {\n",
+            name, bucketmask + 1);
+    for (i = 0 ; i <= bucketmask ; ++i)
+        fprintf(fp, "    %luUL,\n", seeds[i]);
+    fprintf(fp, "};\n\nstatic char const *const %s_ids[%lu] = {\n",
+            name, slotmask + 1);
+    for (i = 0 ; i <= slotmask ; ++i) {
+        if (slots[i] < 0) {
+            fputs("    0,\n", fp);
+        } else {
+            for (n = 0 ; _issym(syms[slots[i]].id[n]) ; ++n) ;
+            fprintf(fp, "    \"%.*s\",\n", n, syms[slots[i]].id);
+        }
+    }
+    fprintf(fp, "};\n\nstatic long const %s_values[%lu] = {\n",
+            name, slotmask + 1);
+    for (i = 0 ; i <= slotmask ; ++i)
+        fprintf(fp, "    %ldL,\n", slots[i] < 0 ? 0L : syms[slots[i]].value);
+    fprintf(fp, "};\n\nstatic char const *const %s_patterns[%d] = {\n",
+            name, set->patcount + 1);
+    for (n = 0 ; n < set->patcount ; ++n)
+        fprintf(fp, "    \"%.*s\",\n", patternlength(set->pats[n].id),
+                set->pats[n].id);
+    fprintf(fp, "    0\n};\n\nstatic long const %s_patternvalues[%d] = {\n",
+            name, set->patcount + 1);
+    for (n = 0 ; n < set->patcount ; ++n)
+        fprintf(fp, "    %ldL,\n", set->pats[n].value);
+    fprintf(fp, "    0L\n};\n\nstatic symtable const %s = {\n"
+                "    0x%lXUL, 0x%lXUL, %s_seeds, %s_ids, %s_values,\n"
+                "    %d, %s_patterns, %s_patternvalues\n};\n",
+            name, slotmask, bucketmask, name, name, name,
+            set->patcount, name, name);
+
+    deallocate(slots);
+    deallocate(seeds);
+    deallocate(syms);
+    return !ferror(fp);
+}
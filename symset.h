@@ -10,12 +10,37 @@
  * are not copied by the symset objects; the caller retains ownership.
  */
 
+#include <stdio.h>
 #include "types.h"
 
+/* A fixed set of symbols, laid out in advance by writesymsettable()
+ * so that it can be compiled into a program. Each symbol occupies the
+ * slot selected by a perfect hash of its name: the name is hashed
+ * once to choose a bucket, and then again with that bucket's seed to
+ * choose the slot. Unused slots have a NULL id. Symbol patterns are
+ * listed separately.
+ */
+struct symtable {
+    unsigned long       slotmask;       /* the number of slots, less one */
+    unsigned long       bucketmask;     /* the number of buckets, less one */
+    unsigned long const *seeds;         /* each bucket's seed */
+    char const *const  *ids;            /* each slot's symbol name */
+    long const         *values;         /* each slot's symbol value */
+    int                 patterncount;   /* the number of patterns */
+    char const *const  *patterns;       /* the symbol patterns */
+    long const         *patternvalues;  /* each pattern's value */
+};
+
 /* Creates an empty set of symbols.
  */
 extern symset *initsymset(void);
 
+/* Creates a set of symbols initially holding the symbols in table,
+ * which must remain valid for as long as the set does. More symbols
+ * can be added to the set, but the table's symbols cannot be removed.
+ */
+extern symset *initsymsetfromtable(symtable const *table);
+
 /* Deallocates the set of symbols.
  */
 extern void freesymset(symset *set);
@@ -24,16 +49,60 @@ extern void freesymset(symset *set);
  */
 extern void addsymboltoset(symset *set, char const *id, long value);
 
+/* Adds a symbol pattern to the set. A pattern is a symbol name that
+ * contains wildcards: an asterisk matches any sequence of characters,
+ * and a question mark matches any single character. As with symbol
+ * names, the pattern string is not copied.
+ */
+extern void addpatterntoset(symset *set, char const *pattern, long value);
+
 /* Finds a symbol in a set. id points to an identifier, typically not
  * NUL-delimited but embedded within a larger string. The return value
  * is true if a symbol with that name is a member of the set. If value
- * is not NULL, it receives the found symbol's value.
+ * is not NULL, it receives the found symbol's value. A symbol that is
+ * not a member can still be found by matching one of the set's
+ * patterns; the symbol itself takes precedence over any pattern, and
+ * among patterns the one with the most literal characters is used.
  */
 extern int findsymbolinset(symset const *set, char const *id, long *value);
 
+/* Determines whether a symbol is to be treated as defined or undefined,
+ * given a set of each. When the symbol is found in both sets, the set
+ * that matches it more specifically prevails: a symbol over a pattern,
+ * and a pattern over one with fewer literal characters. Ties go to the
+ * defined symbols. The return value is positive if the symbol is
+ * defined, in which case value, if not NULL, receives its value;
+ * negative if it is undefined, in which case value receives zero; and
+ * zero if the symbol is in neither set.
+ */
+extern int resolvesymbol(symset const *defs, symset const *undefs,
+                         char const *id, long *value);
+
 /* Removes a symbol from the set. The return value is false if the
  * symbol was not a member of the set.
  */
 extern int removesymbolfromset(symset *set, char const *id);
 
+/* Removes a symbol pattern from the set. The return value is false if
+ * the pattern was not a member of the set.
+ */
+extern int removepatternfromset(symset *set, char const *pattern);
+
+/* Adds every symbol in from to the set. The symbols' names are not
+ * copied, and so must remain valid as long as either set does.
+ */
+extern void copysymbols(symset *set, symset const *from);
+
+/* Computes a key that identifies the set's symbols and their values,
+ * regardless of the order in which they were added.
+ */
+extern void getsymsetkey(symset const *set, contentkey *key);
+
+/* Writes C definitions of a static symtable called name, holding the
+ * symbols in the set, to fp. The definitions refer to the symtable
+ * type, but include no headers. The return value is false if an error
+ * occurs while writing.
+ */
+extern int writesymsettable(symset const *set, char const *name, FILE *fp);
+
 #endif
@@ -0,0 +1,377 @@
+/* tar.c: Copyright (C) 2022 by Brian Raiter <breadbox@muppetlabs.com>
+ * License GPLv2+: GNU GPL version 2 or later.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "gen.h"
+#include "tar.h"
+
+/* The size of the blocks that an archive is made of.
+ */
+#define BLOCKSIZE       512
+
+/* The location of the fields used in a ustar header block.
+ */
+#define NAME_OFFSET     0
+#define NAME_SIZE       100
+#define SIZE_OFFSET     124
+#define SIZE_SIZE       12
+#define CHKSUM_OFFSET   148
+#define CHKSUM_SIZE     8
+#define TYPE_OFFSET     156
+#define MAGIC_OFFSET    257
+#define PREFIX_OFFSET   345
+#define PREFIX_SIZE     155
+
+/* The state of an archive being filtered.
+ */
+typedef struct tarfilter {
+    FILE       *infile;         /* the archive being read */
+    FILE       *outfile;        /* the archive being written */
+    tarselector selector;       /* the function that selects members */
+    tarhandler  handler;        /* the function that handles members */
+    void       *data;           /* extra data passed to the functions */
+    unsigned char block[BLOCKSIZE]; /* the current header block */
+    char       *longname;       /* the next member's name, if extended */
+    int         longsize;       /* true if the next member's size is too */
+} tarfilter;
+
+/* Reads the next block of the archive. The return value is 1 on
+ * success, 0 on a read error, -1 at the end of the file, or -2 if the
+ * file ends partway through the block.
+ */
+static int readblock(FILE *fp, unsigned char *block)
+{
+    size_t n;
+
+    n = fread(block, 1, BLOCKSIZE, fp);
+    if (n == BLOCKSIZE)
+        return 1;
+    if (ferror(fp))
+        return 0;
+    return n ? -2 : -1;
+}
+
+/* Reads the size bytes of data following a header, and the padding
+ * after it, into an allocated buffer. An extra byte is allocated and
+ * set to zero. The return value is NULL if the data could not be read,
+ * in which case errno indicates why.
+ */
+static char *readdata(FILE *fp, unsigned long size)
+{
+    unsigned long padded;
+    char *buf;
+
+    padded = (size + BLOCKSIZE - 1) / BLOCKSIZE * BLOCKSIZE;
+    buf = allocate(padded + 1);
+    if (padded && fread(buf, padded, 1, fp) != 1) {
+        if (!ferror(fp))
+            errno = EINVAL;
+        deallocate(buf);
+        return NULL;
+    }
+    buf[size] = '\0';
+    return buf;
+}
+
+/* Writes size bytes of data, followed by padding to fill the last
+ * block. The return value is false if an error occurs.
+ */
+static int writedata(FILE *fp, char const *buf, unsigned long size)
+{
+    static char const zeros[BLOCKSIZE];
+    unsigned long pad;
+
+    pad = (BLOCKSIZE - size % BLOCKSIZE) % BLOCKSIZE;
+    if (size && fwrite(buf, size, 1, fp) != 1)
+        return FALSE;
+    if (pad && fwrite(zeros, pad, 1, fp) != 1)
+        return FALSE;
+    return TRUE;
+}
+
+/* Copies the size bytes of data following a header, and its padding,
+ * one block at a time. The return value is 1 on success, 0 on an I/O
+ * error, or -1 if the archive ends early.
+ */
+static int copydata(FILE *infile, FILE *outfile, unsigned long size)
+{
+    unsigned char block[BLOCKSIZE];
+    unsigned long n;
+    int r;
+
+    for (n = (size + BLOCKSIZE - 1) / BLOCKSIZE ; n ; --n) {
+        if ((r = readblock(infile, block)) <= 0)
+            return r ? -1 : 0;
+        if (fwrite(block, BLOCKSIZE, 1, outfile) != 1)
+            return 0;
+    }
+    return 1;
+}
+
+/* Reads a numeric field, which is either octal digits, or a binary
+ * number if the high bit of the first byte is set. The return value
+ * is false if the field does not hold a valid number.
+ */
+static int getnumber(unsigned char const *field, int size,
+                     unsigned long *value)
+{
+    int i;
+
+    *value = 0;
+    if (field[0] & 0x80) {
+        for (i = 1 ; i < size ; ++i) {
+            if (*value >> (8 * sizeof *value - 8))
+                return FALSE;
+            *value = (*value << 8) | field[i];
+        }
+        return TRUE;
+    }
+    for (i = 0 ; i < size && field[i] == ' ' ; ++i) ;
+    if (i == size || field[i] < '0' || field[i] > '7')
+        return FALSE;
+    for ( ; i < size && field[i] >= '0' && field[i] <= '7' ; ++i)
+        *value = (*value << 3) | (field[i] - '0');
+    return i == size || field[i] == ' ' || field[i] == '\0';
+}
+
+/* Stores a number in a numeric field, as octal digits followed by a
+ * NUL if it fits, or else as a binary number.
+ */
+static void setnumber(unsigned char *field, int size, unsigned long value)
+{
+    int i;
+
+    if (value >> (3 * (size - 1)) == 0) {
+        for (i = size - 2 ; i >= 0 ; --i, value >>= 3)
+            field[i] = '0' + (value & 7);
+        field[size - 1] = '\0';
+    } else {
+        for (i = size - 1 ; i > 0 ; --i, value >>= 8)
+            field[i] = value & 0xFF;
+        field[0] = 0x80;
+    }
+}
+
+/* Returns the checksum of a header block, which is the sum of its
+ * bytes with the checksum field itself counted as spaces.
+ */
+static unsigned long checksum(unsigned char const *block)
+{
+    unsigned long sum;
+    int i;
+
+    sum = 0;
+    for (i = 0 ; i < BLOCKSIZE ; ++i)
+        if (i < CHKSUM_OFFSET || i >= CHKSUM_OFFSET + CHKSUM_SIZE)
+            sum += block[i];
+    return sum + CHKSUM_SIZE * ' ';
+}
+
+/* Returns true if every byte of the block is zero, which marks the
+ * end of the archive.
+ */
+static int isendblock(unsigned char const *block)
+{
+    int i;
+
+    for (i = 0 ; i < BLOCKSIZE ; ++i)
+        if (block[i])
+            return FALSE;
+    return TRUE;
+}
+
+/* Replaces the name to use for the next member.
+ */
+static void setlongname(tarfilter *tf, char const *name, size_t size)
+{
+    deallocate(tf->longname);
+    tf->longname = allocate(size + 1);
+    memcpy(tf->longname, name, size);
+    tf->longname[size] = '\0';
+}
+
+/* Examines the records of a pax extended header, which have the form
+ * "LENGTH KEY=VALUE\n", for the ones that override the next member's
+ * name and size. The return value is false if a record is malformed.
+ */
+static int readpaxheader(tarfilter *tf, char const *buf, unsigned long size)
+{
+    char const *rec, *key, *end;
+    unsigned long len;
+
+    for (rec = buf ; rec < buf + size ; rec += len) {
+        len = strtoul(rec, (char**)&key, 10);
+        if (len == 0 || *key != ' ' || len > (unsigned long)(buf + size - rec)
+                     || rec[len - 1] != '\n')
+            return FALSE;
+        ++key;
+        end = rec + len - 1;
+        if (end - key > 5 && !memcmp(key, "path=", 5))
+            setlongname(tf, key + 5, end - key - 5);
+        else if (end - key > 5 && !memcmp(key, "size=", 5))
+            tf->longsize = TRUE;
+    }
+    return TRUE;
+}
+
+/* Returns the full pathname of the member described by the current
+ * header block, as an allocated string.
+ */
+static char *getmembername(tarfilter *tf)
+{
+    char const *name, *prefix;
+    char *fullname;
+    size_t namesize, prefixsize;
+
+    if (tf->longname) {
+        fullname = tf->longname;
+        tf->longname = NULL;
+        return fullname;
+    }
+    name = (char const*)tf->block + NAME_OFFSET;
+    namesize = strnlen(name, NAME_SIZE);
+    prefixsize = 0;
+    prefix = (char const*)tf->block + PREFIX_OFFSET;
+    if (!memcmp(tf->block + MAGIC_OFFSET, "ustar", 5))
+        prefixsize = strnlen(prefix, PREFIX_SIZE);
+    fullname = allocate(prefixsize + namesize + 2);
+    if (prefixsize) {
+        memcpy(fullname, prefix, prefixsize);
+        fullname[prefixsize++] = '/';
+    }
+    memcpy(fullname + prefixsize, name, namesize);
+    fullname[prefixsize + namesize] = '\0';
+    return fullname;
+}
+
+/* Reads a selected member's contents, passes them to the handler, and
+ * writes out the member with the new contents. The return value is 1
+ * on success, 0 on an I/O error, or -1 if the archive ends early.
+ */
+static int filtermember(tarfilter *tf, char const *name, unsigned long size)
+{
+    textbuffer out;
+    char *buf;
+    int ret;
+
+    if (!(buf = readdata(tf->infile, size)))
+        return errno == EINVAL ? -1 : 0;
+    out.buf = NULL;
+    out.size = 0;
+    out.allocated = 0;
+    ret = tf->handler(name, buf, size, appendtobuffer, &out, tf->data);
+    deallocate(buf);
+    if (ret) {
+        setnumber(tf->block + SIZE_OFFSET, SIZE_SIZE, out.size);
+        setnumber(tf->block + CHKSUM_OFFSET, CHKSUM_SIZE - 1,
+                  checksum(tf->block));
+        tf->block[CHKSUM_OFFSET + CHKSUM_SIZE - 1] = ' ';
+        ret = fwrite(tf->block, BLOCKSIZE, 1, tf->outfile) == 1
+           && writedata(tf->outfile, out.buf, out.size);
+    }
+    deallocate(out.buf);
+    return ret;
+}
+
+/* Copies one member of the archive, whose header block has already
+ * been read. Extended headers are examined for the name and size of
+ * the member that follows, and other headers that apply to it are
+ * copied without forgetting them. The return value is 1 on success, 0 on an
+ * I/O error, or -1 if the archive is invalid.
+ */
+static int nextmember(tarfilter *tf)
+{
+    unsigned long size, sum;
+    char *buf, *name;
+    int type, ret;
+
+    if (!getnumber(tf->block + CHKSUM_OFFSET, CHKSUM_SIZE, &sum)
+                || sum != checksum(tf->block)
+                || !getnumber(tf->block + SIZE_OFFSET, SIZE_SIZE, &size))
+        return -1;
+    type = tf->block[TYPE_OFFSET];
+
+    if (type == 'x' || type == 'L') {
+        if (!(buf = readdata(tf->infile, size)))
+            return errno == EINVAL ? -1 : 0;
+        ret = 1;
+        if (type == 'L')
+            setlongname(tf, buf, strlen(buf));
+        else if (!readpaxheader(tf, buf, size))
+            ret = -1;
+        if (ret > 0 && (fwrite(tf->block, BLOCKSIZE, 1, tf->outfile) != 1
+                            || !writedata(tf->outfile, buf, size)))
+            ret = 0;
+        deallocate(buf);
+        return ret;
+    }
+
+    if (type == 'g' || type == 'K') {
+        if (fwrite(tf->block, BLOCKSIZE, 1, tf->outfile) != 1)
+            return 0;
+        return copydata(tf->infile, tf->outfile, size);
+    }
+
+    name = NULL;
+    if (type == '0' || type == '\0' || type == '7') {
+        name = getmembername(tf);
+        if (!tf->longsize && tf->selector(name, tf->data)) {
+            ret = filtermember(tf, name, size);
+            deallocate(name);
+            tf->longsize = FALSE;
+            return ret;
+        }
+    }
+    deallocate(name);
+    deallocate(tf->longname);
+    tf->longname = NULL;
+    tf->longsize = FALSE;
+    if (type == '1' || type == '2' || type == '3' || type == '4'
+                    || type == '5' || type == '6')
+        size = 0;
+    if (fwrite(tf->block, BLOCKSIZE, 1, tf->outfile) != 1)
+        return 0;
+    return copydata(tf->infile, tf->outfile, size);
+}
+
+/* Filters each member of the archive in turn. The end-of-archive
+ * marker is always written, even if the input ended without one, and
+ * anything after the marker is read and discarded, so that the writer
+ * of a piped archive is not cut off.
+ */
+int filtertar(FILE *infile, FILE *outfile, tarselector selector,
+              tarhandler handler, void *data)
+{
+    static char const zeros[2 * BLOCKSIZE];
+    tarfilter tf;
+    int ret;
+
+    tf.infile = infile;
+    tf.outfile = outfile;
+    tf.selector = selector;
+    tf.handler = handler;
+    tf.data = data;
+    tf.longname = NULL;
+    tf.longsize = FALSE;
+    for (;;) {
+        ret = readblock(infile, tf.block);
+        if (ret == -2) {
+            ret = -1;
+            break;
+        }
+        if (ret < 0 || (ret > 0 && isendblock(tf.block))) {
+            while (readblock(infile, tf.block) > 0) ;
+            ret = fwrite(zeros, sizeof zeros, 1, outfile) == 1;
+            break;
+        }
+        if (ret > 0)
+            ret = nextmember(&tf);
+        if (ret <= 0)
+            break;
+    }
+    deallocate(tf.longname);
+    return ret;
+}
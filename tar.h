@@ -0,0 +1,41 @@
+/* tar.h: Copyright (C) 2022 by Brian Raiter <breadbox@muppetlabs.com>
+ * License GPLv2+: GNU GPL version 2 or later.
+ */
+#ifndef _tar_h_
+#define _tar_h_
+
+/*
+ * Tar filtering copies a POSIX ustar or pax archive from one stream
+ * to another, passing the contents of selected members through a
+ * handler. Each selected member is held in memory while it is
+ * handled, and its header is rewritten to fit the new contents. All
+ * other members, and all metadata, are copied unchanged.
+ */
+
+#include <stdio.h>
+#include "types.h"
+
+/* The function that is called to select the members to be handled.
+ * name is the member's full pathname within the archive. The return
+ * value is true if the member's contents should be handled.
+ */
+typedef int (*tarselector)(char const *name, void *data);
+
+/* The function that is called to handle a selected member. The size
+ * bytes at buf are the member's contents, and the new contents are
+ * passed to sink along with sinkdata. The return value is false if
+ * the new contents could not be produced.
+ */
+typedef int (*tarhandler)(char const *name, char const *buf, size_t size,
+                          textsink sink, void *sinkdata, void *data);
+
+/* Copies the archive read from infile to outfile, replacing the
+ * contents of each regular file accepted by selector with the output
+ * of handler. The return value is 1 on success, 0 if a file could not
+ * be read or written (with errno set), or -1 if the input is not a
+ * valid archive.
+ */
+extern int filtertar(FILE *infile, FILE *outfile, tarselector selector,
+                     tarhandler handler, void *data);
+
+#endif
@@ -0,0 +1,78 @@
+/* apitest.cpp: Copyright (C) 2022 by Brian Raiter <breadbox@muppetlabs.com>
+ * License GPLv2+: GNU GPL version 2 or later.
+ */
+
+/*
+ * A helper for testing the library interface. It partially
+ * preprocesses standard input using cppp.hpp and writes the result to
+ * standard output, so that the output can be compared with that of
+ * the program. With -e, a unified diff of the changes is produced
+ * instead. With -c, the number of chunks that were copied from the
+ * input without being altered is written to standard error. With -f,
+ * the input is fed to the preprocessor in pieces of the given size.
+ * -t enables trigraphs.
+ *
+ * Usage: apitest [-e] [-c] [-t] [-f SIZE] [-DSYMBOL[=VALUE]] [-USYMBOL] ...
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include "../cppp.hpp"
+
+int main(int argc, char *argv[])
+{
+    cppp::symbols defs, undefs;
+    bool edits = false, count = false, ok;
+    std::size_t piece = 0;
+    char const *eq;
+
+    for (int i = 1 ; i < argc ; ++i) {
+        if (!std::strcmp(argv[i], "-e")) {
+            edits = true;
+        } else if (!std::strcmp(argv[i], "-c")) {
+            count = true;
+        } else if (!std::strcmp(argv[i], "-t")) {
+            enabletrigraphs(1);
+        } else if (!std::strcmp(argv[i], "-f") && i + 1 < argc) {
+            piece = std::strtoul(argv[++i], nullptr, 10);
+        } else if (!std::strncmp(argv[i], "-D", 2)) {
+            eq = std::strchr(argv[i], '=');
+            if (eq)
+                defs.add(std::string_view(argv[i] + 2, eq - argv[i] - 2),
+                         std::atol(eq + 1));
+            else
+                defs.add(argv[i] + 2);
+        } else if (!std::strncmp(argv[i], "-U", 2)) {
+            undefs.add(argv[i] + 2);
+        } else {
+            std::cerr << "apitest: invalid argument " << argv[i] << "\n";
+            return 2;
+        }
+    }
+
+    std::string input(std::istreambuf_iterator<char>(std::cin), {});
+    cppp::preprocessor pp(defs, undefs);
+    pp.edits(edits);
+    if (piece) {
+        pp.begin([](std::string_view text) {
+            std::fwrite(text.data(), 1, text.size(), stdout);
+        }, "-");
+        for (std::size_t pos = 0 ; pos < input.size() ; pos += piece)
+            pp.feed(std::string_view(input).substr(pos, piece));
+        return pp.finish() ? 0 : 1;
+    }
+    cppp::output out = pp.process(input, "-", &ok);
+    int n = 0;
+    for (std::string_view chunk : out) {
+        std::fwrite(chunk.data(), 1, chunk.size(), stdout);
+        if (chunk.data() >= input.data()
+                    && chunk.data() < input.data() + input.size())
+            ++n;
+    }
+    if (count)
+        std::cerr << n << "\n";
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,1002 @@
+#if foo
+#elif bar == 0
+arm0
+#elif bar == 1
+arm1
+#elif bar == 2
+arm2
+#elif bar == 3
+arm3
+#elif bar == 4
+arm4
+#elif bar == 5
+arm5
+#elif bar == 6
+arm6
+#elif bar == 7
+arm7
+#elif bar == 8
+arm8
+#elif bar == 9
+arm9
+#elif bar == 10
+arm10
+#elif bar == 11
+arm11
+#elif bar == 12
+arm12
+#elif bar == 13
+arm13
+#elif bar == 14
+arm14
+#elif bar == 15
+arm15
+#elif bar == 16
+arm16
+#elif bar == 17
+arm17
+#elif bar == 18
+arm18
+#elif bar == 19
+arm19
+#elif bar == 20
+arm20
+#elif bar == 21
+arm21
+#elif bar == 22
+arm22
+#elif bar == 23
+arm23
+#elif bar == 24
+arm24
+#elif bar == 25
+arm25
+#elif bar == 26
+arm26
+#elif bar == 27
+arm27
+#elif bar == 28
+arm28
+#elif bar == 29
+arm29
+#elif bar == 30
+arm30
+#elif bar == 31
+arm31
+#elif bar == 32
+arm32
+#elif bar == 33
+arm33
+#elif bar == 34
+arm34
+#elif bar == 35
+arm35
+#elif bar == 36
+arm36
+#elif bar == 37
+arm37
+#elif bar == 38
+arm38
+#elif bar == 39
+arm39
+#elif bar == 40
+arm40
+#elif bar == 41
+arm41
+#elif bar == 42
+arm42
+#elif bar == 43
+arm43
+#elif bar == 44
+arm44
+#elif bar == 45
+arm45
+#elif bar == 46
+arm46
+#elif bar == 47
+arm47
+#elif bar == 48
+arm48
+#elif bar == 49
+arm49
+#elif bar == 50
+arm50
+#elif bar == 51
+arm51
+#elif bar == 52
+arm52
+#elif bar == 53
+arm53
+#elif bar == 54
+arm54
+#elif bar == 55
+arm55
+#elif bar == 56
+arm56
+#elif bar == 57
+arm57
+#elif bar == 58
+arm58
+#elif bar == 59
+arm59
+#elif bar == 60
+arm60
+#elif bar == 61
+arm61
+#elif bar == 62
+arm62
+#elif bar == 63
+arm63
+#elif bar == 64
+arm64
+#elif bar == 65
+arm65
+#elif bar == 66
+arm66
+#elif bar == 67
+arm67
+#elif bar == 68
+arm68
+#elif bar == 69
+arm69
+#elif bar == 70
+arm70
+#elif bar == 71
+arm71
+#elif bar == 72
+arm72
+#elif bar == 73
+arm73
+#elif bar == 74
+arm74
+#elif bar == 75
+arm75
+#elif bar == 76
+arm76
+#elif bar == 77
+arm77
+#elif bar == 78
+arm78
+#elif bar == 79
+arm79
+#elif bar == 80
+arm80
+#elif bar == 81
+arm81
+#elif bar == 82
+arm82
+#elif bar == 83
+arm83
+#elif bar == 84
+arm84
+#elif bar == 85
+arm85
+#elif bar == 86
+arm86
+#elif bar == 87
+arm87
+#elif bar == 88
+arm88
+#elif bar == 89
+arm89
+#elif bar == 90
+arm90
+#elif bar == 91
+arm91
+#elif bar == 92
+arm92
+#elif bar == 93
+arm93
+#elif bar == 94
+arm94
+#elif bar == 95
+arm95
+#elif bar == 96
+arm96
+#elif bar == 97
+arm97
+#elif bar == 98
+arm98
+#elif bar == 99
+arm99
+#elif bar == 100
+arm100
+#elif bar == 101
+arm101
+#elif bar == 102
+arm102
+#elif bar == 103
+arm103
+#elif bar == 104
+arm104
+#elif bar == 105
+arm105
+#elif bar == 106
+arm106
+#elif bar == 107
+arm107
+#elif bar == 108
+arm108
+#elif bar == 109
+arm109
+#elif bar == 110
+arm110
+#elif bar == 111
+arm111
+#elif bar == 112
+arm112
+#elif bar == 113
+arm113
+#elif bar == 114
+arm114
+#elif bar == 115
+arm115
+#elif bar == 116
+arm116
+#elif bar == 117
+arm117
+#elif bar == 118
+arm118
+#elif bar == 119
+arm119
+#elif bar == 120
+arm120
+#elif bar == 121
+arm121
+#elif bar == 122
+arm122
+#elif bar == 123
+arm123
+#elif bar == 124
+arm124
+#elif bar == 125
+arm125
+#elif bar == 126
+arm126
+#elif bar == 127
+arm127
+#elif bar == 128
+arm128
+#elif bar == 129
+arm129
+#elif bar == 130
+arm130
+#elif bar == 131
+arm131
+#elif bar == 132
+arm132
+#elif bar == 133
+arm133
+#elif bar == 134
+arm134
+#elif bar == 135
+arm135
+#elif bar == 136
+arm136
+#elif bar == 137
+arm137
+#elif bar == 138
+arm138
+#elif bar == 139
+arm139
+#elif bar == 140
+arm140
+#elif bar == 141
+arm141
+#elif bar == 142
+arm142
+#elif bar == 143
+arm143
+#elif bar == 144
+arm144
+#elif bar == 145
+arm145
+#elif bar == 146
+arm146
+#elif bar == 147
+arm147
+#elif bar == 148
+arm148
+#elif bar == 149
+arm149
+#elif bar == 150
+arm150
+#elif bar == 151
+arm151
+#elif bar == 152
+arm152
+#elif bar == 153
+arm153
+#elif bar == 154
+arm154
+#elif bar == 155
+arm155
+#elif bar == 156
+arm156
+#elif bar == 157
+arm157
+#elif bar == 158
+arm158
+#elif bar == 159
+arm159
+#elif bar == 160
+arm160
+#elif bar == 161
+arm161
+#elif bar == 162
+arm162
+#elif bar == 163
+arm163
+#elif bar == 164
+arm164
+#elif bar == 165
+arm165
+#elif bar == 166
+arm166
+#elif bar == 167
+arm167
+#elif bar == 168
+arm168
+#elif bar == 169
+arm169
+#elif bar == 170
+arm170
+#elif bar == 171
+arm171
+#elif bar == 172
+arm172
+#elif bar == 173
+arm173
+#elif bar == 174
+arm174
+#elif bar == 175
+arm175
+#elif bar == 176
+arm176
+#elif bar == 177
+arm177
+#elif bar == 178
+arm178
+#elif bar == 179
+arm179
+#elif bar == 180
+arm180
+#elif bar == 181
+arm181
+#elif bar == 182
+arm182
+#elif bar == 183
+arm183
+#elif bar == 184
+arm184
+#elif bar == 185
+arm185
+#elif bar == 186
+arm186
+#elif bar == 187
+arm187
+#elif bar == 188
+arm188
+#elif bar == 189
+arm189
+#elif bar == 190
+arm190
+#elif bar == 191
+arm191
+#elif bar == 192
+arm192
+#elif bar == 193
+arm193
+#elif bar == 194
+arm194
+#elif bar == 195
+arm195
+#elif bar == 196
+arm196
+#elif bar == 197
+arm197
+#elif bar == 198
+arm198
+#elif bar == 199
+arm199
+#elif bar == 200
+arm200
+#elif bar == 201
+arm201
+#elif bar == 202
+arm202
+#elif bar == 203
+arm203
+#elif bar == 204
+arm204
+#elif bar == 205
+arm205
+#elif bar == 206
+arm206
+#elif bar == 207
+arm207
+#elif bar == 208
+arm208
+#elif bar == 209
+arm209
+#elif bar == 210
+arm210
+#elif bar == 211
+arm211
+#elif bar == 212
+arm212
+#elif bar == 213
+arm213
+#elif bar == 214
+arm214
+#elif bar == 215
+arm215
+#elif bar == 216
+arm216
+#elif bar == 217
+arm217
+#elif bar == 218
+arm218
+#elif bar == 219
+arm219
+#elif bar == 220
+arm220
+#elif bar == 221
+arm221
+#elif bar == 222
+arm222
+#elif bar == 223
+arm223
+#elif bar == 224
+arm224
+#elif bar == 225
+arm225
+#elif bar == 226
+arm226
+#elif bar == 227
+arm227
+#elif bar == 228
+arm228
+#elif bar == 229
+arm229
+#elif bar == 230
+arm230
+#elif bar == 231
+arm231
+#elif bar == 232
+arm232
+#elif bar == 233
+arm233
+#elif bar == 234
+arm234
+#elif bar == 235
+arm235
+#elif bar == 236
+arm236
+#elif bar == 237
+arm237
+#elif bar == 238
+arm238
+#elif bar == 239
+arm239
+#elif bar == 240
+arm240
+#elif bar == 241
+arm241
+#elif bar == 242
+arm242
+#elif bar == 243
+arm243
+#elif bar == 244
+arm244
+#elif bar == 245
+arm245
+#elif bar == 246
+arm246
+#elif bar == 247
+arm247
+#elif bar == 248
+arm248
+#elif bar == 249
+arm249
+#elif bar == 250
+arm250
+#elif bar == 251
+arm251
+#elif bar == 252
+arm252
+#elif bar == 253
+arm253
+#elif bar == 254
+arm254
+#elif bar == 255
+arm255
+#elif bar == 256
+arm256
+#elif bar == 257
+arm257
+#elif bar == 258
+arm258
+#elif bar == 259
+arm259
+#elif bar == 260
+arm260
+#elif bar == 261
+arm261
+#elif bar == 262
+arm262
+#elif bar == 263
+arm263
+#elif bar == 264
+arm264
+#elif bar == 265
+arm265
+#elif bar == 266
+arm266
+#elif bar == 267
+arm267
+#elif bar == 268
+arm268
+#elif bar == 269
+arm269
+#elif bar == 270
+arm270
+#elif bar == 271
+arm271
+#elif bar == 272
+arm272
+#elif bar == 273
+arm273
+#elif bar == 274
+arm274
+#elif bar == 275
+arm275
+#elif bar == 276
+arm276
+#elif bar == 277
+arm277
+#elif bar == 278
+arm278
+#elif bar == 279
+arm279
+#elif bar == 280
+arm280
+#elif bar == 281
+arm281
+#elif bar == 282
+arm282
+#elif bar == 283
+arm283
+#elif bar == 284
+arm284
+#elif bar == 285
+arm285
+#elif bar == 286
+arm286
+#elif bar == 287
+arm287
+#elif bar == 288
+arm288
+#elif bar == 289
+arm289
+#elif bar == 290
+arm290
+#elif bar == 291
+arm291
+#elif bar == 292
+arm292
+#elif bar == 293
+arm293
+#elif bar == 294
+arm294
+#elif bar == 295
+arm295
+#elif bar == 296
+arm296
+#elif bar == 297
+arm297
+#elif bar == 298
+arm298
+#elif bar == 299
+arm299
+#elif bar == 300
+arm300
+#elif bar == 301
+arm301
+#elif bar == 302
+arm302
+#elif bar == 303
+arm303
+#elif bar == 304
+arm304
+#elif bar == 305
+arm305
+#elif bar == 306
+arm306
+#elif bar == 307
+arm307
+#elif bar == 308
+arm308
+#elif bar == 309
+arm309
+#elif bar == 310
+arm310
+#elif bar == 311
+arm311
+#elif bar == 312
+arm312
+#elif bar == 313
+arm313
+#elif bar == 314
+arm314
+#elif bar == 315
+arm315
+#elif bar == 316
+arm316
+#elif bar == 317
+arm317
+#elif bar == 318
+arm318
+#elif bar == 319
+arm319
+#elif bar == 320
+arm320
+#elif bar == 321
+arm321
+#elif bar == 322
+arm322
+#elif bar == 323
+arm323
+#elif bar == 324
+arm324
+#elif bar == 325
+arm325
+#elif bar == 326
+arm326
+#elif bar == 327
+arm327
+#elif bar == 328
+arm328
+#elif bar == 329
+arm329
+#elif bar == 330
+arm330
+#elif bar == 331
+arm331
+#elif bar == 332
+arm332
+#elif bar == 333
+arm333
+#elif bar == 334
+arm334
+#elif bar == 335
+arm335
+#elif bar == 336
+arm336
+#elif bar == 337
+arm337
+#elif bar == 338
+arm338
+#elif bar == 339
+arm339
+#elif bar == 340
+arm340
+#elif bar == 341
+arm341
+#elif bar == 342
+arm342
+#elif bar == 343
+arm343
+#elif bar == 344
+arm344
+#elif bar == 345
+arm345
+#elif bar == 346
+arm346
+#elif bar == 347
+arm347
+#elif bar == 348
+arm348
+#elif bar == 349
+arm349
+#elif bar == 350
+arm350
+#elif bar == 351
+arm351
+#elif bar == 352
+arm352
+#elif bar == 353
+arm353
+#elif bar == 354
+arm354
+#elif bar == 355
+arm355
+#elif bar == 356
+arm356
+#elif bar == 357
+arm357
+#elif bar == 358
+arm358
+#elif bar == 359
+arm359
+#elif bar == 360
+arm360
+#elif bar == 361
+arm361
+#elif bar == 362
+arm362
+#elif bar == 363
+arm363
+#elif bar == 364
+arm364
+#elif bar == 365
+arm365
+#elif bar == 366
+arm366
+#elif bar == 367
+arm367
+#elif bar == 368
+arm368
+#elif bar == 369
+arm369
+#elif bar == 370
+arm370
+#elif bar == 371
+arm371
+#elif bar == 372
+arm372
+#elif bar == 373
+arm373
+#elif bar == 374
+arm374
+#elif bar == 375
+arm375
+#elif bar == 376
+arm376
+#elif bar == 377
+arm377
+#elif bar == 378
+arm378
+#elif bar == 379
+arm379
+#elif bar == 380
+arm380
+#elif bar == 381
+arm381
+#elif bar == 382
+arm382
+#elif bar == 383
+arm383
+#elif bar == 384
+arm384
+#elif bar == 385
+arm385
+#elif bar == 386
+arm386
+#elif bar == 387
+arm387
+#elif bar == 388
+arm388
+#elif bar == 389
+arm389
+#elif bar == 390
+arm390
+#elif bar == 391
+arm391
+#elif bar == 392
+arm392
+#elif bar == 393
+arm393
+#elif bar == 394
+arm394
+#elif bar == 395
+arm395
+#elif bar == 396
+arm396
+#elif bar == 397
+arm397
+#elif bar == 398
+arm398
+#elif bar == 399
+arm399
+#elif bar == 400
+arm400
+#elif bar == 401
+arm401
+#elif bar == 402
+arm402
+#elif bar == 403
+arm403
+#elif bar == 404
+arm404
+#elif bar == 405
+arm405
+#elif bar == 406
+arm406
+#elif bar == 407
+arm407
+#elif bar == 408
+arm408
+#elif bar == 409
+arm409
+#elif bar == 410
+arm410
+#elif bar == 411
+arm411
+#elif bar == 412
+arm412
+#elif bar == 413
+arm413
+#elif bar == 414
+arm414
+#elif bar == 415
+arm415
+#elif bar == 416
+arm416
+#elif bar == 417
+arm417
+#elif bar == 418
+arm418
+#elif bar == 419
+arm419
+#elif bar == 420
+arm420
+#elif bar == 421
+arm421
+#elif bar == 422
+arm422
+#elif bar == 423
+arm423
+#elif bar == 424
+arm424
+#elif bar == 425
+arm425
+#elif bar == 426
+arm426
+#elif bar == 427
+arm427
+#elif bar == 428
+arm428
+#elif bar == 429
+arm429
+#elif bar == 430
+arm430
+#elif bar == 431
+arm431
+#elif bar == 432
+arm432
+#elif bar == 433
+arm433
+#elif bar == 434
+arm434
+#elif bar == 435
+arm435
+#elif bar == 436
+arm436
+#elif bar == 437
+arm437
+#elif bar == 438
+arm438
+#elif bar == 439
+arm439
+#elif bar == 440
+arm440
+#elif bar == 441
+arm441
+#elif bar == 442
+arm442
+#elif bar == 443
+arm443
+#elif bar == 444
+arm444
+#elif bar == 445
+arm445
+#elif bar == 446
+arm446
+#elif bar == 447
+arm447
+#elif bar == 448
+arm448
+#elif bar == 449
+arm449
+#elif bar == 450
+arm450
+#elif bar == 451
+arm451
+#elif bar == 452
+arm452
+#elif bar == 453
+arm453
+#elif bar == 454
+arm454
+#elif bar == 455
+arm455
+#elif bar == 456
+arm456
+#elif bar == 457
+arm457
+#elif bar == 458
+arm458
+#elif bar == 459
+arm459
+#elif bar == 460
+arm460
+#elif bar == 461
+arm461
+#elif bar == 462
+arm462
+#elif bar == 463
+arm463
+#elif bar == 464
+arm464
+#elif bar == 465
+arm465
+#elif bar == 466
+arm466
+#elif bar == 467
+arm467
+#elif bar == 468
+arm468
+#elif bar == 469
+arm469
+#elif bar == 470
+arm470
+#elif bar == 471
+arm471
+#elif bar == 472
+arm472
+#elif bar == 473
+arm473
+#elif bar == 474
+arm474
+#elif bar == 475
+arm475
+#elif bar == 476
+arm476
+#elif bar == 477
+arm477
+#elif bar == 478
+arm478
+#elif bar == 479
+arm479
+#elif bar == 480
+arm480
+#elif bar == 481
+arm481
+#elif bar == 482
+arm482
+#elif bar == 483
+arm483
+#elif bar == 484
+arm484
+#elif bar == 485
+arm485
+#elif bar == 486
+arm486
+#elif bar == 487
+arm487
+#elif bar == 488
+arm488
+#elif bar == 489
+arm489
+#elif bar == 490
+arm490
+#elif bar == 491
+arm491
+#elif bar == 492
+arm492
+#elif bar == 493
+arm493
+#elif bar == 494
+arm494
+#elif bar == 495
+arm495
+#elif bar == 496
+arm496
+#elif bar == 497
+arm497
+#elif bar == 498
+arm498
+#elif bar == 499
+arm499
+#endif
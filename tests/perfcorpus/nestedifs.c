@@ -0,0 +1,1401 @@
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+#if qux
+#ifdef foo
+body
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
+#endif
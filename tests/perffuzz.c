@@ -0,0 +1,522 @@
+/* perffuzz.c: Copyright (C) 2022 by Brian Raiter <breadbox@muppetlabs.com>
+ * License GPLv2+: GNU GPL version 2 or later.
+ */
+
+/*
+ * A fuzzer that looks for inputs which are slow to process, rather
+ * than ones which crash. It repeatedly mutates a pool of inputs and
+ * partially preprocesses each one in memory, measuring the CPU time
+ * and the peak memory allocated. An input whose cost exceeds a budget
+ * proportional to its size is reduced to a smaller input that still
+ * exceeds it, and saved in the corpus directory. The pool favors the
+ * inputs that come closest to the budget, so that the search climbs
+ * towards superlinear behavior. An input that runs for more than ten
+ * seconds is saved as it is. With -r, each file is processed in turn,
+ * and the exit status is non-zero if any exceeds the budget; this is
+ * how "make test" replays the corpus.
+ *
+ * When compiled with -DLIBFUZZER and linked with clang's
+ * -fsanitize=fuzzer, the program is instead a libFuzzer target, which
+ * aborts on an input over the budget so that libFuzzer saves it (and
+ * minimizes it, with -minimize_crash=1).
+ *
+ * The symbols are always foo defined, bar defined as 2, and baz
+ * undefined, with trigraphs enabled, so that a saved input behaves
+ * the same when it is replayed.
+ *
+ * Usage: perffuzz [-n RUNS] [-s SEED] [-o CORPUS] FILE ...
+ *        perffuzz -r FILE ...
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "../gen.h"
+#include "../types.h"
+#include "../error.h"
+#include "../symset.h"
+#include "../ppproc.h"
+
+/* The budget for an input of a given size: a fixed allowance plus an
+ * amount per byte, for CPU time in nanoseconds and for peak memory in
+ * bytes. Ordinary source code uses well under a tenth of this, and
+ * even the worst cases known to be linear use less than half.
+ */
+#define TIME_BASE       2000000.0
+#define TIME_PER_BYTE   2000.0
+#define MEM_BASE        262144.0
+#define MEM_PER_BYTE    256.0
+
+/* The largest input that is generated.
+ */
+#define MAXSIZE         65536
+
+/* The number of inputs kept in the pool.
+ */
+#define POOLSIZE        64
+
+/* The number of times an input is measured before its time is taken
+ * to be over budget, since the first measurement may be unlucky.
+ */
+#define CONFIRMRUNS     3
+
+/* The most inputs that are tried while reducing one.
+ */
+#define MAXREDUCE       2000
+
+/* How long an input may run before it is deemed to be hung.
+ */
+#define HANGSECONDS     10
+
+/* Fragments that mutations insert, chosen to reach the parts of the
+ * program with the most complicated behavior.
+ */
+static char const *const fragments[] = {
+    "#if ", "#elif ", "#else\n", "#endif\n", "#ifdef foo\n", "#ifndef ",
+    "#elifdef bar\n", "#define ", "defined(foo)", "defined bar", "foo",
+    "bar", "baz", "qux", " || ", " && ", "!", "(", ")", " ? ", " : ",
+    " == 2", " + ", "-", "1", "0x10", "'a'", "\"s\"", "/*", "*/", "//",
+    "\\\n", "?\?/\n", "?\?=", "\r\n", "\n", " "
+};
+
+/* The preprocessor, and the input being processed in case it hangs.
+ */
+static ppproc *ppp;
+static char const *current;
+static size_t currentsize;
+static char hangname[4096];
+
+/* The state of the random number generator.
+ */
+static unsigned long rngstate = 1;
+
+/* The pool of inputs, and each one's cost relative to the budget.
+ */
+typedef struct input {
+    char       *buf;            /* the contents */
+    size_t      size;           /* the length of the contents */
+    double      score;          /* the cost as a fraction of the budget */
+} input;
+
+/* Returns a random number less than n, which must be positive.
+ */
+static unsigned long rnd(unsigned long n)
+{
+    rngstate ^= rngstate << 13;
+    rngstate ^= rngstate >> 7;
+    rngstate ^= rngstate << 17;
+    return (rngstate & 0xFFFFFFFFUL) % n;
+}
+
+/* Discards the output.
+ */
+static int discard(char const *text, size_t size, void *data)
+{
+    (void)text;
+    (void)size;
+    (void)data;
+    return 1;
+}
+
+/* Saves the input being processed and exits, when it has taken too
+ * long. Only async-signal-safe functions are used.
+ */
+static void hung(int sig)
+{
+    int fd;
+
+    (void)sig;
+    fd = open(hangname, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd >= 0 && write(fd, current, currentsize) >= 0)
+        close(fd);
+    if (write(STDERR_FILENO, "perffuzz: input hung\n", 21) < 0)
+        _exit(3);
+    _exit(2);
+}
+
+/* Processes an input once, and measures the CPU time it took in
+ * nanoseconds and the most memory it had allocated at once.
+ */
+static void measure(char const *buf, size_t size, double *nsecs, double *peak)
+{
+    struct timespec t0, t1;
+    memstats s;
+    size_t base;
+
+    resetmempeak();
+    getmemstats(memTagCount, &s);
+    base = s.bytes;
+    current = buf;
+    currentsize = size;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &t0);
+    partialpreprocessbuffer(ppp, buf, size, discard, NULL, "fuzz");
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &t1);
+    getmemstats(memTagCount, &s);
+    *nsecs = (t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec);
+    *peak = (double)(s.peak - base);
+}
+
+/* Returns the cost of processing an input as a fraction of its budget,
+ * so that a value above 1 is over budget. An input that appears to be
+ * over budget is measured again, up to runs times in all, and the
+ * fastest time is used.
+ */
+static double cost(char const *buf, size_t size, int runs)
+{
+    double nsecs, best, peak, t, m;
+    int i;
+
+    best = 0.0;
+    for (i = 0 ; i < runs ; ++i) {
+        measure(buf, size, &nsecs, &peak);
+        if (!i || nsecs < best)
+            best = nsecs;
+        if (best <= TIME_BASE + TIME_PER_BYTE * size)
+            break;
+    }
+    t = best / (TIME_BASE + TIME_PER_BYTE * size);
+    m = peak / (MEM_BASE + MEM_PER_BYTE * size);
+    return t > m ? t : m;
+}
+
+/* Reads an entire file into an allocated buffer. The return value is
+ * NULL if the file cannot be read.
+ */
+static char *readfile(char const *filename, size_t *size)
+{
+    FILE *fp;
+    char *buf;
+    size_t allocated;
+
+    if (!(fp = fopen(filename, "rb"))) {
+        perror(filename);
+        return NULL;
+    }
+    allocated = 4096;
+    buf = allocate(allocated);
+    *size = 0;
+    for (;;) {
+        *size += fread(buf + *size, 1, allocated - *size, fp);
+        if (*size < allocated)
+            break;
+        allocated *= 2;
+        buf = reallocate(buf, allocated);
+    }
+    if (ferror(fp)) {
+        perror(filename);
+        deallocate(buf);
+        buf = NULL;
+    }
+    fclose(fp);
+    return buf;
+}
+
+/* Inserts text into an input at the given position, as long as the
+ * result is not too large.
+ */
+static void insert(input *in, size_t pos, char const *text, size_t size)
+{
+    if (in->size + size > MAXSIZE)
+        return;
+    in->buf = reallocate(in->buf, in->size + size + 1);
+    memmove(in->buf + pos + size, in->buf + pos, in->size - pos);
+    memcpy(in->buf + pos, text, size);
+    in->size += size;
+}
+
+/* Makes a copy of an input with one or more random changes. Besides
+ * small edits, a range can be repeated or copied from another input,
+ * which lets the size of a troublesome construct grow quickly.
+ */
+static void mutate(input *child, input const *pool, int count)
+{
+    input const *other;
+    char *copy;
+    size_t pos, len;
+    int edits, n, i;
+    char ch;
+
+    edits = 1 + rnd(4);
+    while (edits--) {
+        pos = rnd(child->size + 1);
+        len = child->size - pos ? 1 + rnd(child->size - pos) : 0;
+        switch (rnd(6)) {
+          case 0:
+            n = rnd(sizearray(fragments));
+            insert(child, pos, fragments[n], strlen(fragments[n]));
+            break;
+          case 1:
+            if (len) {
+                memmove(child->buf + pos, child->buf + pos + len,
+                        child->size - pos - len);
+                child->size -= len;
+            }
+            break;
+          case 2:
+            if (len) {
+                n = 1 + rnd(8);
+                copy = allocate(len);
+                memcpy(copy, child->buf + pos, len);
+                for (i = 0 ; i < n ; ++i)
+                    insert(child, pos, copy, len);
+                deallocate(copy);
+            }
+            break;
+          case 3:
+            if (child->size) {
+                ch = (char)(rnd(4) ? ' ' + rnd(95) : '\n');
+                child->buf[rnd(child->size)] = ch;
+            }
+            break;
+          case 4:
+            other = &pool[rnd(count)];
+            if (other->size) {
+                n = rnd(other->size);
+                len = 1 + rnd(other->size - n);
+                copy = allocate(len);
+                memcpy(copy, other->buf + n, len);
+                insert(child, pos, copy, len);
+                deallocate(copy);
+            }
+            break;
+          case 5:
+            insert(child, pos, "\n", 1);
+            break;
+        }
+    }
+}
+
+/* Removes ever smaller pieces of an input over the budget, as long as
+ * what remains is still over the budget. The return value is the new
+ * size.
+ */
+static size_t reduce(char *buf, size_t size)
+{
+    char *trial;
+    size_t chunk, pos;
+    int tries;
+
+    trial = allocate(size + 1);
+    tries = 0;
+    for (chunk = size / 2 ; chunk && tries < MAXREDUCE ; chunk /= 2) {
+        pos = 0;
+        while (pos + chunk <= size && chunk < size && tries < MAXREDUCE) {
+            memcpy(trial, buf, pos);
+            memcpy(trial + pos, buf + pos + chunk, size - pos - chunk);
+            ++tries;
+            if (cost(trial, size - chunk, CONFIRMRUNS) > 1.0) {
+                memcpy(buf, trial, size - chunk);
+                size -= chunk;
+            } else {
+                pos += chunk;
+            }
+        }
+    }
+    deallocate(trial);
+    return size;
+}
+
+/* Writes an input to a file in the corpus directory, named for its
+ * contents.
+ */
+static void save(char const *dirname, char const *prefix,
+                 char const *buf, size_t size, double score)
+{
+    contentkey key;
+    char *filename;
+    FILE *fp;
+
+    initcontentkey(&key);
+    addtocontentkey(&key, buf, size);
+    filename = allocate(strlen(dirname) + strlen(prefix) + 32);
+    sprintf(filename, "%s/%s-%08lx%08lx.c", dirname, prefix,
+            key.hash[0], key.hash[1]);
+    if (!(fp = fopen(filename, "wb")) || fwrite(buf, 1, size, fp) != size
+                                      || fclose(fp)) {
+        perror(filename);
+    } else {
+        printf("%s: %lu bytes, %.1f times the budget\n",
+               filename, (unsigned long)size, score);
+        fflush(stdout);
+    }
+    deallocate(filename);
+}
+
+/* Creates the preprocessor with the fixed set of symbols.
+ */
+static void setup(symset **defs, symset **undefs)
+{
+    *defs = initsymset();
+    *undefs = initsymset();
+    addsymboltoset(*defs, "foo", 1);
+    addsymboltoset(*defs, "bar", 2);
+    addsymboltoset(*undefs, "baz", 0);
+    enabletrigraphs(TRUE);
+    muteerrors(TRUE);
+    ppp = initppproc(*defs, *undefs);
+}
+
+#ifdef LIBFUZZER
+
+/* The entry point for libFuzzer.
+ */
+int LLVMFuzzerTestOneInput(unsigned char const *data, size_t size)
+{
+    static symset *defs, *undefs;
+    double score;
+
+    if (!ppp)
+        setup(&defs, &undefs);
+    if (size > MAXSIZE)
+        return 0;
+    score = cost((char const*)data, size, CONFIRMRUNS);
+    if (score > 1.0) {
+        fprintf(stderr, "perffuzz: %lu bytes, %.1f times the budget\n",
+                (unsigned long)size, score);
+        abort();
+    }
+    return 0;
+}
+
+#else
+
+/* Replays the given files, and reports those over the budget. The
+ * return value is false if any are.
+ */
+static int replay(int count, char *filenames[])
+{
+    char *buf;
+    size_t size;
+    double score;
+    int ret, i;
+
+    ret = TRUE;
+    for (i = 0 ; i < count ; ++i) {
+        if (!(buf = readfile(filenames[i], &size))) {
+            ret = FALSE;
+            continue;
+        }
+        score = cost(buf, size, CONFIRMRUNS);
+        if (score > 1.0) {
+            fprintf(stderr, "perffuzz: %s is %.1f times the budget\n",
+                    filenames[i], score);
+            ret = FALSE;
+        }
+        deallocate(buf);
+    }
+    return ret;
+}
+
+/* Mutates the inputs in the pool for the given number of runs, and
+ * saves each input found that exceeds the budget. The return value is
+ * the number of inputs saved.
+ */
+static int search(input *pool, int count, long runs, char const *dirname)
+{
+    input child;
+    long run;
+    int found, worst, i;
+
+    found = 0;
+    for (run = 0 ; run < runs ; ++run) {
+        i = rnd(count);
+        child.size = pool[i].size;
+        child.buf = allocate(child.size + 1);
+        memcpy(child.buf, pool[i].buf, child.size);
+        mutate(&child, pool, count);
+        alarm(HANGSECONDS);
+        child.score = cost(child.buf, child.size, 1);
+        if (child.score > 1.0)
+            child.score = cost(child.buf, child.size, CONFIRMRUNS);
+        alarm(0);
+        if (child.score > 1.0) {
+            child.size = reduce(child.buf, child.size);
+            save(dirname, "slow", child.buf, child.size,
+                 cost(child.buf, child.size, CONFIRMRUNS));
+            ++found;
+            deallocate(child.buf);
+            continue;
+        }
+        if (count < POOLSIZE) {
+            pool[count++] = child;
+            continue;
+        }
+        worst = 0;
+        for (i = 1 ; i < count ; ++i)
+            if (pool[i].score < pool[worst].score)
+                worst = i;
+        if (child.score > pool[worst].score) {
+            deallocate(pool[worst].buf);
+            pool[worst] = child;
+        } else {
+            deallocate(child.buf);
+        }
+    }
+    for (i = 0 ; i < count ; ++i)
+        deallocate(pool[i].buf);
+    return found;
+}
+
+/* Parse the command line, and either replay files or search for new
+ * inputs.
+ */
+int main(int argc, char *argv[])
+{
+    symset *defs, *undefs;
+    input pool[POOLSIZE];
+    char const *dirname;
+    long runs;
+    int replaying, count, ret, i;
+
+    dirname = ".";
+    runs = 100000;
+    replaying = FALSE;
+    for (i = 1 ; i < argc && argv[i][0] == '-' ; ++i) {
+        if (!strcmp(argv[i], "-r"))
+            replaying = TRUE;
+        else if (!strcmp(argv[i], "-n") && i + 1 < argc)
+            runs = atol(argv[++i]);
+        else if (!strcmp(argv[i], "-s") && i + 1 < argc)
+            rngstate = strtoul(argv[++i], NULL, 0) | 1;
+        else if (!strcmp(argv[i], "-o") && i + 1 < argc)
+            dirname = argv[++i];
+        else
+            break;
+    }
+    if (i == argc || argv[i][0] == '-') {
+        fputs("Usage: perffuzz [-n RUNS] [-s SEED] [-o CORPUS] FILE ...\n"
+              "       perffuzz -r FILE ...\n", stderr);
+        return EXIT_FAILURE;
+    }
+
+    setup(&defs, &undefs);
+    if (replaying) {
+        ret = replay(argc - i, argv + i) ? EXIT_SUCCESS : EXIT_FAILURE;
+    } else {
+        sprintf(hangname, "%.4000s/hang.c", dirname);
+        signal(SIGALRM, hung);
+        for (count = 0 ; i < argc && count < POOLSIZE ; ++i) {
+            pool[count].buf = readfile(argv[i], &pool[count].size);
+            if (!pool[count].buf)
+                continue;
+            if (pool[count].size > MAXSIZE)
+                pool[count].size = MAXSIZE;
+            pool[count].score = cost(pool[count].buf, pool[count].size, 1);
+            ++count;
+        }
+        if (!count)
+            return EXIT_FAILURE;
+        ret = search(pool, count, runs, dirname) ? EXIT_FAILURE
+                                                  : EXIT_SUCCESS;
+    }
+    freeppproc(ppp);
+    freesymset(defs);
+    freesymset(undefs);
+    return ret;
+}
+
+#endif
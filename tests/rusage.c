@@ -0,0 +1,63 @@
+/* rusage.c: Copyright (C) 2022 by Brian Raiter <breadbox@muppetlabs.com>
+ * License GPLv2+: GNU GPL version 2 or later.
+ */
+
+/*
+ * A helper for the complexity tests. It runs a command, discarding
+ * its standard output, and then reports the CPU time in milliseconds
+ * and the peak memory usage in kilobytes that the command consumed.
+ *
+ * Usage: rusage COMMAND [ARG ...]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+/* Run the command and report its resource usage. The exit status is
+ * non-zero if the command could not be run or did not succeed.
+ */
+int main(int argc, char *argv[])
+{
+    struct rusage usage;
+    pid_t pid;
+    long msecs;
+    int status, fd;
+
+    if (argc < 2) {
+        fputs("Usage: rusage COMMAND [ARG ...]\n", stderr);
+        return EXIT_FAILURE;
+    }
+    pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        return EXIT_FAILURE;
+    }
+    if (pid == 0) {
+        fd = open("/dev/null", O_WRONLY);
+        if (fd >= 0) {
+            dup2(fd, STDOUT_FILENO);
+            close(fd);
+        }
+        execvp(argv[1], argv + 1);
+        perror(argv[1]);
+        _exit(127);
+    }
+    if (wait4(pid, &status, 0, &usage) < 0) {
+        perror("wait4");
+        return EXIT_FAILURE;
+    }
+    if (!WIFEXITED(status) || WEXITSTATUS(status)) {
+        fprintf(stderr, "rusage: %s did not succeed\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+    msecs = (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000L
+          + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000L;
+    printf("%ld %ld\n", msecs, usage.ru_maxrss);
+    return EXIT_SUCCESS;
+}
@@ -6,10 +6,26 @@
 #ifndef _types_h_
 #define _types_h_
 
+#include <stddef.h>
+
 typedef struct symset symset;
+typedef struct symtable symtable;
 typedef struct mstr mstr;
 typedef struct clexer clexer;
 typedef struct exptree exptree;
 typedef struct ppproc ppproc;
+typedef struct udiff udiff;
+typedef struct depindex depindex;
+typedef struct varset varset;
+typedef struct compdb compdb;
+typedef struct journal journal;
+typedef struct contentkey contentkey;
+
+/* A function that receives a run of output text. The text is only
+ * guaranteed to remain valid for the duration of the call. data is
+ * supplied by whoever provided the function. The return value is
+ * false if the text could not be written.
+ */
+typedef int (*textsink)(char const *text, size_t size, void *data);
 
 #endif
@@ -0,0 +1,239 @@
+/* udiff.c: Copyright (C) 2022 by Brian Raiter <breadbox@muppetlabs.com>
+ * License GPLv2+: GNU GPL version 2 or later.
+ */
+#include <stdio.h>
+#include <string.h>
+#define MEMTAG memUdiff
+#include "gen.h"
+#include "types.h"
+#include "udiff.h"
+
+/* A growable buffer holding one side of a hunk.
+ */
+typedef struct textbuf {
+    char       *buf;            /* the text */
+    int         size;           /* the length of the text */
+    int         allocated;      /* the size of the buffer */
+} textbuf;
+
+/* The state of a unified diff in progress.
+ */
+struct udiff {
+    char const *name;           /* the filename to use in the header */
+    textsink    sink;           /* where the diff is output */
+    void       *sinkdata;       /* the data passed to sink */
+    int         failed;         /* true if the output could not be written */
+    int         headerdone;     /* true if the header has been output */
+    unsigned long oldline;      /* line number of the next input line */
+    unsigned long newline;      /* line number of the next output line */
+    unsigned long oldstart;     /* first input line of the pending hunk */
+    unsigned long newstart;     /* first output line of the pending hunk */
+    unsigned long oldcount;     /* input lines in the pending hunk */
+    unsigned long newcount;     /* output lines in the pending hunk */
+    textbuf     removed;        /* input text of the pending hunk */
+    textbuf     added;          /* output text of the pending hunk */
+    int         mark;           /* where the current line begins in removed */
+};
+
+/* Allocates a udiff object.
+ */
+udiff *initudiff(void)
+{
+    udiff *ud;
+
+    ud = allocate(sizeof *ud);
+    ud->removed.buf = NULL;
+    ud->removed.allocated = 0;
+    ud->added.buf = NULL;
+    ud->added.allocated = 0;
+    beginudiff(ud, NULL, writetofile, stdout);
+    return ud;
+}
+
+/* Deallocates the udiff object.
+ */
+void freeudiff(udiff *ud)
+{
+    deallocate(ud->removed.buf);
+    deallocate(ud->added.buf);
+    deallocate(ud);
+}
+
+/* Appends text to a buffer, enlarging it as necessary.
+ */
+static void appendtext(textbuf *tb, char const *text, int size)
+{
+    if (tb->size + size > tb->allocated) {
+        tb->allocated = tb->allocated ? 2 * tb->allocated : 256;
+        if (tb->allocated < tb->size + size)
+            tb->allocated = tb->size + size;
+        tb->buf = reallocate(tb->buf, tb->allocated);
+    }
+    memcpy(tb->buf + tb->size, text, size);
+    tb->size += size;
+}
+
+/* Returns the number of lines in text. A final line lacking a newline
+ * is still counted.
+ */
+static unsigned long countlines(char const *text, int size)
+{
+    unsigned long n;
+    int i;
+
+    n = 0;
+    for (i = 0 ; i < size ; ++i)
+        if (text[i] == '\n')
+            ++n;
+    if (size && text[size - 1] != '\n')
+        ++n;
+    return n;
+}
+
+/* Passes text to the output, remembering if it could not be written.
+ */
+static void put(udiff *ud, char const *text, size_t size)
+{
+    if (!ud->failed && !ud->sink(text, size, ud->sinkdata))
+        ud->failed = TRUE;
+}
+
+/* Outputs a null-terminated string.
+ */
+static void puts0(udiff *ud, char const *str)
+{
+    put(ud, str, strlen(str));
+}
+
+/* Outputs a hunk's line range in the format used in hunk headers.
+ * Empty ranges are identified by the line preceding them.
+ */
+static void writerange(udiff *ud, unsigned long start, unsigned long count)
+{
+    char buf[64];
+
+    if (count == 1)
+        sprintf(buf, "%lu", start);
+    else
+        sprintf(buf, "%lu,%lu", count ? start : start - 1, count);
+    puts0(ud, buf);
+}
+
+/* Outputs every line in a buffer with the given prefix character.
+ */
+static void writelines(udiff *ud, char const *prefix, textbuf const *tb)
+{
+    char const *p, *end, *nl;
+
+    end = tb->buf + tb->size;
+    for (p = tb->buf ; p < end ; p = nl) {
+        nl = memchr(p, '\n', end - p);
+        nl = nl ? nl + 1 : end;
+        put(ud, prefix, 1);
+        put(ud, p, nl - p);
+        if (nl[-1] != '\n')
+            puts0(ud, "\n\\ No newline at end of file\n");
+    }
+}
+
+/* Outputs the pending hunk, if there is one, preceded by the file
+ * header if this is the file's first hunk.
+ */
+static int flushhunk(udiff *ud)
+{
+    if (!ud->oldcount && !ud->newcount)
+        return !ud->failed;
+    if (!ud->headerdone) {
+        puts0(ud, "--- ");
+        puts0(ud, ud->name);
+        puts0(ud, "\n+++ ");
+        puts0(ud, ud->name);
+        puts0(ud, "\n");
+        ud->headerdone = TRUE;
+    }
+    puts0(ud, "@@ -");
+    writerange(ud, ud->oldstart, ud->oldcount);
+    puts0(ud, " +");
+    writerange(ud, ud->newstart, ud->newcount);
+    puts0(ud, " @@\n");
+    writelines(ud, "-", &ud->removed);
+    writelines(ud, "+", &ud->added);
+    ud->oldcount = 0;
+    ud->newcount = 0;
+    ud->removed.size = 0;
+    ud->added.size = 0;
+    return !ud->failed;
+}
+
+/* Resets the udiff object to the start of a new file.
+ */
+void beginudiff(udiff *ud, char const *name, textsink sink, void *data)
+{
+    ud->name = name ? name : "-";
+    ud->sink = sink;
+    ud->sinkdata = data;
+    ud->failed = FALSE;
+    ud->headerdone = FALSE;
+    ud->oldline = 1;
+    ud->newline = 1;
+    ud->oldcount = 0;
+    ud->newcount = 0;
+    ud->removed.size = 0;
+    ud->added.size = 0;
+    ud->mark = 0;
+}
+
+/* Stores a copy of the next input line at the end of the pending
+ * hunk's input text, where it will be removed again if the line turns
+ * out to be unchanged.
+ */
+void udiffinput(udiff *ud, char const *text, int size)
+{
+    ud->mark = ud->removed.size;
+    appendtext(&ud->removed, text, size);
+}
+
+/* Compares the output line with the stored input line. Unchanged
+ * lines end the pending hunk. Changed lines are added to it, starting
+ * a new hunk if necessary.
+ */
+int udiffoutput(udiff *ud, char const *text, int size)
+{
+    char const *old;
+    unsigned long n;
+    int oldsize;
+
+    old = ud->removed.buf + ud->mark;
+    oldsize = ud->removed.size - ud->mark;
+    if (text && size == oldsize && !memcmp(text, old, size)) {
+        ud->removed.size = ud->mark;
+        n = countlines(text, size);
+        if (!flushhunk(ud))
+            return 0;
+        ud->oldline += n;
+        ud->newline += n;
+        return 1;
+    }
+
+    if (!ud->oldcount && !ud->newcount) {
+        ud->oldstart = ud->oldline;
+        ud->newstart = ud->newline;
+    }
+    n = countlines(old, oldsize);
+    ud->oldcount += n;
+    ud->oldline += n;
+    if (text) {
+        appendtext(&ud->added, text, size);
+        n = countlines(text, size);
+        ud->newcount += n;
+        ud->newline += n;
+    }
+    return 1;
+}
+
+/* Outputs whatever is left of the file's changes.
+ */
+int endudiff(udiff *ud)
+{
+    return flushhunk(ud);
+}
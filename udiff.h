@@ -0,0 +1,48 @@
+/* udiff.h: Copyright (C) 2022 by Brian Raiter <breadbox@muppetlabs.com>
+ * License GPLv2+: GNU GPL version 2 or later.
+ */
+#ifndef _udiff_h_
+#define _udiff_h_
+
+/*
+ * A udiff object collects the changes made to a file, one line at a
+ * time, and outputs them as a unified diff with no context lines.
+ * Unchanged lines are never copied, and a file that is not changed at
+ * all produces no output.
+ */
+
+#include "types.h"
+
+/* Creates a new udiff object.
+ */
+extern udiff *initudiff(void);
+
+/* Deallocates the udiff object.
+ */
+extern void freeudiff(udiff *ud);
+
+/* Begins a new file. name is used to label the file in the diff's
+ * header, which is only output if the file has any changes. The
+ * file's diff is passed to sink, along with data.
+ */
+extern void beginudiff(udiff *ud, char const *name,
+                       textsink sink, void *data);
+
+/* Records the original contents of the next line of input. The text
+ * is copied, so the caller may then alter it freely.
+ */
+extern void udiffinput(udiff *ud, char const *text, int size);
+
+/* Records the output produced for the line most recently passed to
+ * udiffinput(). text is NULL if the line was removed entirely. Any
+ * completed hunks are output. The return value is false if an error
+ * occurs while writing.
+ */
+extern int udiffoutput(udiff *ud, char const *text, int size);
+
+/* Finishes the current file, outputting any pending hunk. The return
+ * value is false if an error occurs while writing.
+ */
+extern int endudiff(udiff *ud);
+
+#endif
@@ -3,7 +3,10 @@
  * This is free software; you are free to change and redistribute it.
  * There is NO WARRANTY, to the extent permitted by law.
  */
+#include <stdlib.h>
 #include <string.h>
+#include <stdio.h>
+#include <io.h>
 #include <windows.h>
 #include "unixisms.h"
 
@@ -51,3 +54,131 @@ char const *getbasefilename(char const *name)
     r = strrchr(name, '\\');
     return r && r[1] ? r + 1 : name;
 }
+
+/* Reads the entries of a directory into an array.
+ */
+char **listdirectory(char const *name)
+{
+    WIN32_FIND_DATA data;
+    HANDLE h;
+    char pattern[MAX_PATH];
+    char **list, **p;
+    int count, allocated;
+
+    if (strlen(name) + 3 > sizeof pattern)
+        return NULL;
+    strcpy(pattern, name);
+    strcat(pattern, "\\*");
+    h = FindFirstFile(pattern, &data);
+    if (h == INVALID_HANDLE_VALUE)
+        return NULL;
+    allocated = 16;
+    list = malloc(allocated * sizeof *list);
+    count = 0;
+    while (list) {
+        if (strcmp(data.cFileName, ".") && strcmp(data.cFileName, "..")) {
+            if (count + 1 == allocated) {
+                allocated *= 2;
+                p = realloc(list, allocated * sizeof *list);
+                if (!p) {
+                    while (count)
+                        free(list[--count]);
+                    free(list);
+                    list = NULL;
+                    break;
+                }
+                list = p;
+            }
+            list[count] = malloc(strlen(data.cFileName) + 1);
+            if (list[count])
+                strcpy(list[count++], data.cFileName);
+        }
+        if (!FindNextFile(h, &data))
+            break;
+    }
+    FindClose(h);
+    if (list)
+        list[count] = NULL;
+    return list;
+}
+
+/* Creates the missing directories in a pathname, one at a time.
+ */
+int makeparentdirs(char const *name)
+{
+    char *path, *p;
+    int ret;
+
+    path = malloc(strlen(name) + 1);
+    if (!path)
+        return 0;
+    strcpy(path, name);
+    ret = 1;
+    for (p = path + 1 ; *p ; ++p) {
+        if (*p != '\\' && *p != '/')
+            continue;
+        *p = '\0';
+        if (!CreateDirectory(path, NULL)
+                        && GetLastError() != ERROR_ALREADY_EXISTS) {
+            ret = 0;
+            break;
+        }
+        *p = '\\';
+    }
+    free(path);
+    return ret;
+}
+
+/* Replaces a file with a hard link.
+ */
+int linkfile(char const *src, char const *dest)
+{
+    DeleteFile(dest);
+    return CreateHardLink(dest, src, NULL);
+}
+
+/* Cloning files is not supported.
+ */
+int clonefile(char const *src, char const *dest)
+{
+    (void)src;
+    (void)dest;
+    return 0;
+}
+
+/* Returns the current directory in an allocated buffer.
+ */
+char *getcurrentdir(void)
+{
+    char *buf;
+    DWORD size;
+
+    size = GetCurrentDirectory(0, NULL);
+    if (!size || !(buf = malloc(size)))
+        return NULL;
+    if (!GetCurrentDirectory(size, buf)) {
+        free(buf);
+        return NULL;
+    }
+    return buf;
+}
+
+/* Makes each call in turn, since there is no fork().
+ */
+int runparallel(int count, int (*fn)(int n, void *data), void *data)
+{
+    int ret, n;
+
+    ret = 1;
+    for (n = 0 ; n < count ; ++n)
+        if (!fn(n, data))
+            ret = 0;
+    return ret;
+}
+
+/* Writes the stream to disk with _commit().
+ */
+int syncfile(FILE *fp)
+{
+    return !fflush(fp) && !_commit(_fileno(fp));
+}
@@ -6,8 +6,15 @@
 #include <string.h>
 #include <errno.h>
 #include <unistd.h>
+#include <dirent.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <stdio.h>
+#include <sys/wait.h>
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#endif
 #include "unixisms.h"
 
 /* Changes the current directory.
@@ -38,6 +45,158 @@ char const *getbasefilename(char const *name)
     return r && r[1] ? r + 1 : name;
 }
 
+/* Reads the entries of a directory into an array.
+ */
+char **listdirectory(char const *name)
+{
+    DIR *dir;
+    struct dirent *entry;
+    char **list, **p;
+    int count, allocated;
+
+    dir = opendir(name);
+    if (!dir)
+        return NULL;
+    allocated = 16;
+    list = malloc(allocated * sizeof *list);
+    count = 0;
+    while (list && (entry = readdir(dir))) {
+        if (!strcmp(entry->d_name, ".") || !strcmp(entry->d_name, ".."))
+            continue;
+        if (count + 1 == allocated) {
+            allocated *= 2;
+            p = realloc(list, allocated * sizeof *list);
+            if (!p) {
+                while (count)
+                    free(list[--count]);
+                free(list);
+                list = NULL;
+                break;
+            }
+            list = p;
+        }
+        list[count] = malloc(strlen(entry->d_name) + 1);
+        if (list[count])
+            strcpy(list[count++], entry->d_name);
+    }
+    closedir(dir);
+    if (list)
+        list[count] = NULL;
+    return list;
+}
+
+/* Creates the missing directories in a pathname, one at a time.
+ */
+int makeparentdirs(char const *name)
+{
+    char *path, *p;
+    int ret;
+
+    path = malloc(strlen(name) + 1);
+    if (!path)
+        return 0;
+    strcpy(path, name);
+    ret = 1;
+    for (p = strchr(path + 1, '/') ; p ; p = strchr(p + 1, '/')) {
+        *p = '\0';
+        if (mkdir(path, 0777) && errno != EEXIST) {
+            ret = 0;
+            break;
+        }
+        *p = '/';
+    }
+    free(path);
+    return ret;
+}
+
+/* Replaces a file with a hard link.
+ */
+int linkfile(char const *src, char const *dest)
+{
+    if (unlink(dest) && errno != ENOENT)
+        return 0;
+    return link(src, dest) == 0;
+}
+
+/* Replaces a file with a clone, on filesystems that support it.
+ */
+int clonefile(char const *src, char const *dest)
+{
+#ifdef FICLONE
+    int srcfd, destfd, ret;
+
+    srcfd = open(src, O_RDONLY);
+    if (srcfd < 0)
+        return 0;
+    destfd = open(dest, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (destfd < 0) {
+        close(srcfd);
+        return 0;
+    }
+    ret = ioctl(destfd, FICLONE, srcfd) == 0;
+    close(destfd);
+    close(srcfd);
+    return ret;
+#else
+    (void)src;
+    (void)dest;
+    return 0;
+#endif
+}
+
+/* Returns the current directory in an allocated buffer.
+ */
+char *getcurrentdir(void)
+{
+    char *buf, *p;
+    size_t size;
+
+    size = 256;
+    buf = malloc(size);
+    while (buf && !getcwd(buf, size)) {
+        if (errno != ERANGE) {
+            free(buf);
+            return NULL;
+        }
+        size *= 2;
+        p = realloc(buf, size);
+        if (!p)
+            free(buf);
+        buf = p;
+    }
+    return buf;
+}
+
+/* Forks a child process for each call, and waits for all of them to
+ * exit. A call that cannot be forked is made in this process instead.
+ */
+int runparallel(int count, int (*fn)(int n, void *data), void *data)
+{
+    pid_t pid;
+    int ret, status, n;
+
+    ret = 1;
+    for (n = 0 ; n < count ; ++n) {
+        fflush(NULL);
+        pid = fork();
+        if (pid == 0)
+            exit(fn(n, data) ? EXIT_SUCCESS : EXIT_FAILURE);
+        if (pid < 0 && !fn(n, data))
+            ret = 0;
+    }
+    while ((pid = wait(&status)) > 0 || (pid < 0 && errno == EINTR))
+        if (pid > 0 && (!WIFEXITED(status) || WEXITSTATUS(status)))
+            ret = 0;
+    return ret;
+}
+
+/* Writes the stream to disk with fsync().
+ */
+int syncfile(FILE *fp)
+{
+    return !fflush(fp) && !fsync(fileno(fp));
+}
+
 /* The fchdir() function makes savedir() and restoredir() trivial to
  * code, but sadly it isn't universal. To maximize portability, a
  * fallback version of these functions is provided.
@@ -5,6 +5,8 @@
 #ifndef _unixisms_h_
 #define _unixisms_h_
 
+#include <stdio.h>
+
 /*
  * Basic functionality not provided by the standard C library. The
  * implementation of these functions is platform-dependent.
@@ -36,4 +38,45 @@ extern int fileisdir(char const *name);
  */
 extern char const *getbasefilename(char const *name);
 
+/* Return the names of the entries in the given directory, not
+ * including "." and "..", as a NULL-terminated array. The array and
+ * each of its strings are allocated with malloc(). NULL is returned
+ * if the directory cannot be read.
+ */
+extern char **listdirectory(char const *name);
+
+/* Create each of the directories leading up to the last component of
+ * the given pathname, if they do not already exist. The return value
+ * is false if a directory could not be created.
+ */
+extern int makeparentdirs(char const *name);
+
+/* Make dest a hard link to the file src, replacing any file already
+ * named dest. The return value is false if the link could not be
+ * made, such as when the two are on different filesystems.
+ */
+extern int linkfile(char const *src, char const *dest);
+
+/* Make dest a copy-on-write clone of the file src, replacing any file
+ * already named dest. The return value is false if the filesystem does
+ * not support cloning.
+ */
+extern int clonefile(char const *src, char const *dest);
+
+/* Return the pathname of the current directory, allocated with
+ * malloc(), or NULL if it cannot be determined.
+ */
+extern char *getcurrentdir(void);
+
+/* Call fn count times, each in its own process where possible, with
+ * n ranging from 0 to count - 1. The return value is false if any of
+ * the calls returned false.
+ */
+extern int runparallel(int count, int (*fn)(int n, void *data), void *data);
+
+/* Flush the stream's buffer and then wait for the file's contents to
+ * reach the disk. The return value is false if an error occurs.
+ */
+extern int syncfile(FILE *fp);
+
 #endif
@@ -0,0 +1,372 @@
+/* watch.c: Copyright (C) 2022 by Brian Raiter <breadbox@muppetlabs.com>
+ * License GPLv2+: GNU GPL version 2 or later.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <sys/inotify.h>
+#include "gen.h"
+#include "watch.h"
+
+/* How long the source tree must be quiet before the pending files are
+ * processed, in milliseconds.
+ */
+#define QUIET_TIME      50
+
+/* The events that indicate a file needs to be processed again.
+ */
+#define WATCH_EVENTS    (IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | \
+                         IN_MOVED_FROM | IN_MOVED_TO)
+
+/* The state of the watcher.
+ */
+typedef struct watcher {
+    int         fd;             /* the inotify file descriptor */
+    char const *srcdir;         /* the top of the source tree */
+    char const *destdir;        /* the top of the destination tree */
+    watchhandler handler;       /* the function that processes files */
+    void       *data;           /* extra data passed to the handler */
+    char      **dirs;           /* the directory for each watch descriptor */
+    int         dirsallocated;  /* the size of the dirs array */
+    char      **pending;        /* files waiting to be processed */
+    int         pendingcount;   /* how many files are waiting */
+    int         pendingallocated; /* the size of the pending array */
+    int        *chains;         /* the next file in each pending file's
+                                   hash chain, or -1 */
+    int        *buckets;        /* the first file in each hash chain */
+    int         bucketcount;    /* the number of hash chains */
+} watcher;
+
+/* Set when the watcher receives a signal to terminate.
+ */
+static volatile sig_atomic_t stopping = FALSE;
+
+/* Signal handler for terminating the watcher.
+ */
+static void stopwatch(int sig)
+{
+    (void)sig;
+    stopping = TRUE;
+}
+
+/* Returns a newly allocated pathname made by appending name to dir.
+ * Either argument can be an empty string.
+ */
+static char *joinpath(char const *dir, char const *name)
+{
+    char *path;
+    size_t dirsize, namesize;
+
+    dirsize = strlen(dir);
+    namesize = strlen(name);
+    path = allocate(dirsize + namesize + 2);
+    memcpy(path, dir, dirsize);
+    if (dirsize && namesize && dir[dirsize - 1] != '/')
+        path[dirsize++] = '/';
+    memcpy(path + dirsize, name, namesize + 1);
+    return path;
+}
+
+/* Records the relative pathname of the directory belonging to a watch
+ * descriptor.
+ */
+static void setwatchdir(watcher *w, int wd, char const *dir)
+{
+    int n;
+
+    if (wd >= w->dirsallocated) {
+        n = w->dirsallocated;
+        w->dirsallocated = wd < 2 * n ? 2 * n : wd + 16;
+        w->dirs = reallocate(w->dirs, w->dirsallocated * sizeof *w->dirs);
+        while (n < w->dirsallocated)
+            w->dirs[n++] = NULL;
+    }
+    deallocate(w->dirs[wd]);
+    w->dirs[wd] = joinpath(dir, "");
+}
+
+static void updatefile(watcher *w, char const *relpath);
+
+/* Removes an entry from the destination tree. If the entry is a
+ * directory, everything inside of it is removed first. Symbolic links
+ * are removed without being followed.
+ */
+static void removedest(char const *dest)
+{
+    DIR *dir;
+    struct dirent *entry;
+    struct stat s;
+    char *path;
+
+    if (lstat(dest, &s)) {
+        if (errno != ENOENT)
+            perror(dest);
+        return;
+    }
+    if (!S_ISDIR(s.st_mode)) {
+        if (unlink(dest) && errno != ENOENT)
+            perror(dest);
+        return;
+    }
+    dir = opendir(dest);
+    if (!dir) {
+        perror(dest);
+        return;
+    }
+    while ((entry = readdir(dir))) {
+        if (!strcmp(entry->d_name, ".") || !strcmp(entry->d_name, ".."))
+            continue;
+        path = joinpath(dest, entry->d_name);
+        removedest(path);
+        deallocate(path);
+    }
+    closedir(dir);
+    if (rmdir(dest) && errno != ENOENT)
+        perror(dest);
+}
+
+/* Creates the destination directory, adds a watch on the source
+ * directory, and processes everything inside of it.
+ */
+static void walkdir(watcher *w, char const *reldir)
+{
+    DIR *dir;
+    struct dirent *entry;
+    char *src, *dest, *relpath;
+    int wd;
+
+    src = joinpath(w->srcdir, reldir);
+    dest = joinpath(w->destdir, reldir);
+    if (mkdir(dest, 0777) && errno != EEXIST)
+        perror(dest);
+    wd = inotify_add_watch(w->fd, src, WATCH_EVENTS | IN_ONLYDIR);
+    if (wd < 0)
+        perror(src);
+    else
+        setwatchdir(w, wd, reldir);
+    dir = opendir(src);
+    if (!dir) {
+        perror(src);
+    } else {
+        while ((entry = readdir(dir))) {
+            if (!strcmp(entry->d_name, ".") || !strcmp(entry->d_name, ".."))
+                continue;
+            relpath = joinpath(reldir, entry->d_name);
+            updatefile(w, relpath);
+            deallocate(relpath);
+        }
+        closedir(dir);
+    }
+    deallocate(src);
+    deallocate(dest);
+}
+
+/* Brings a single entry of the destination tree up to date with the
+ * source tree. Files are processed, new directories are walked, and
+ * files and directories that no longer exist are removed.
+ */
+static void updatefile(watcher *w, char const *relpath)
+{
+    struct stat s;
+    char *src, *dest;
+
+    src = joinpath(w->srcdir, relpath);
+    dest = joinpath(w->destdir, relpath);
+    if (stat(src, &s)) {
+        if (errno == ENOENT && *relpath)
+            removedest(dest);
+        else
+            perror(src);
+    } else if (S_ISDIR(s.st_mode)) {
+        walkdir(w, relpath);
+    } else if (S_ISREG(s.st_mode)) {
+        w->handler(src, dest, w->data);
+    }
+    deallocate(src);
+    deallocate(dest);
+}
+
+/* Returns the hash chain that a pending file belongs in.
+ */
+static int pendingbucket(watcher const *w, char const *relpath)
+{
+    contentkey key;
+
+    initcontentkey(&key);
+    addtocontentkey(&key, relpath, strlen(relpath));
+    return (int)(key.hash[0] % w->bucketcount);
+}
+
+/* Enlarges the hash table of pending files, so that the chains stay
+ * short, and puts the pending files in their new chains.
+ */
+static void growpending(watcher *w)
+{
+    int i, n;
+
+    w->bucketcount = w->bucketcount ? 2 * w->bucketcount : 64;
+    w->buckets = reallocate(w->buckets,
+                            w->bucketcount * sizeof *w->buckets);
+    for (i = 0 ; i < w->bucketcount ; ++i)
+        w->buckets[i] = -1;
+    for (i = 0 ; i < w->pendingcount ; ++i) {
+        n = pendingbucket(w, w->pending[i]);
+        w->chains[i] = w->buckets[n];
+        w->buckets[n] = i;
+    }
+}
+
+/* Adds a file to the list of files waiting to be processed, unless it
+ * is already present. The pending files are kept in a hash table, so
+ * that a burst of events does not take quadratic time to coalesce.
+ */
+static void addpending(watcher *w, char const *dir, char const *name)
+{
+    char *relpath;
+    int i, n;
+
+    relpath = joinpath(dir, name);
+    if (w->pendingcount >= w->bucketcount)
+        growpending(w);
+    n = pendingbucket(w, relpath);
+    for (i = w->buckets[n] ; i >= 0 ; i = w->chains[i]) {
+        if (!strcmp(w->pending[i], relpath)) {
+            deallocate(relpath);
+            return;
+        }
+    }
+    if (w->pendingcount == w->pendingallocated) {
+        w->pendingallocated = w->pendingallocated ? 2 * w->pendingallocated
+                                                  : 16;
+        w->pending = reallocate(w->pending,
+                                w->pendingallocated * sizeof *w->pending);
+        w->chains = reallocate(w->chains,
+                               w->pendingallocated * sizeof *w->chains);
+    }
+    w->chains[w->pendingcount] = w->buckets[n];
+    w->buckets[n] = w->pendingcount;
+    w->pending[w->pendingcount++] = relpath;
+}
+
+/* Processes all of the pending files.
+ */
+static void flushpending(watcher *w)
+{
+    int i;
+
+    for (i = 0 ; i < w->pendingcount ; ++i) {
+        updatefile(w, w->pending[i]);
+        deallocate(w->pending[i]);
+    }
+    w->pendingcount = 0;
+    for (i = 0 ; i < w->bucketcount ; ++i)
+        w->buckets[i] = -1;
+    fflush(NULL);
+}
+
+/* Reads the available inotify events and turns them into pending
+ * files. The return value is false if the events could not be read.
+ */
+static int readevents(watcher *w)
+{
+    char buf[4096]
+        __attribute__ ((aligned(__alignof__(struct inotify_event))));
+    struct inotify_event const *event;
+    char const *p;
+    ssize_t size;
+
+    size = read(w->fd, buf, sizeof buf);
+    if (size < 0)
+        return errno == EINTR || errno == EAGAIN;
+    for (p = buf ; p < buf + size ; p += sizeof *event + event->len) {
+        event = (struct inotify_event const*)p;
+        if (event->mask & IN_Q_OVERFLOW) {
+            addpending(w, "", "");
+        } else if (event->mask & IN_IGNORED) {
+            if (event->wd < w->dirsallocated) {
+                deallocate(w->dirs[event->wd]);
+                w->dirs[event->wd] = NULL;
+            }
+        } else if (event->len && event->wd < w->dirsallocated
+                              && w->dirs[event->wd]) {
+            if ((event->mask & IN_CREATE) && !(event->mask & IN_ISDIR))
+                continue;
+            addpending(w, w->dirs[event->wd], event->name);
+        }
+    }
+    return TRUE;
+}
+
+/* Walks the source tree, and then waits for changes to it. Events are
+ * accumulated until no new events arrive for QUIET_TIME milliseconds,
+ * at which point the affected files are processed.
+ */
+int runwatch(char const *srcdir, char const *destdir,
+             watchhandler handler, void *data)
+{
+    struct sigaction act;
+    struct pollfd pfd;
+    watcher w;
+    int i, n;
+
+    w.fd = inotify_init();
+    if (w.fd < 0)
+        return FALSE;
+    w.srcdir = srcdir;
+    w.destdir = destdir;
+    w.handler = handler;
+    w.data = data;
+    w.dirs = NULL;
+    w.dirsallocated = 0;
+    w.pending = NULL;
+    w.pendingcount = 0;
+    w.pendingallocated = 0;
+    w.chains = NULL;
+    w.buckets = NULL;
+    w.bucketcount = 0;
+
+    memset(&act, 0, sizeof act);
+    act.sa_handler = stopwatch;
+    sigemptyset(&act.sa_mask);
+    sigaction(SIGINT, &act, NULL);
+    sigaction(SIGTERM, &act, NULL);
+    sigaction(SIGHUP, &act, NULL);
+
+    walkdir(&w, "");
+    fflush(NULL);
+
+    pfd.fd = w.fd;
+    pfd.events = POLLIN;
+    while (!stopping) {
+        n = poll(&pfd, 1, w.pendingcount ? QUIET_TIME : -1);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            perror("poll");
+            break;
+        }
+        if (n == 0) {
+            flushpending(&w);
+        } else if (!readevents(&w)) {
+            perror("inotify");
+            break;
+        }
+    }
+
+    for (i = 0 ; i < w.pendingcount ; ++i)
+        deallocate(w.pending[i]);
+    deallocate(w.pending);
+    deallocate(w.chains);
+    deallocate(w.buckets);
+    for (i = 0 ; i < w.dirsallocated ; ++i)
+        deallocate(w.dirs[i]);
+    deallocate(w.dirs);
+    close(w.fd);
+    return TRUE;
+}
@@ -0,0 +1,33 @@
+/* watch.h: Copyright (C) 2022 by Brian Raiter <breadbox@muppetlabs.com>
+ * License GPLv2+: GNU GPL version 2 or later.
+ */
+#ifndef _watch_h_
+#define _watch_h_
+
+/*
+ * Watch mode mirrors a source directory tree into a destination tree,
+ * passing every file through a handler. After the initial pass, the
+ * source tree is monitored (via inotify), and only the files that
+ * change are handed off again. Bursts of events are coalesced, so
+ * that each file is handled once per burst regardless of how many
+ * events the burst generated for it.
+ */
+
+/* The function that is called to process a single file. srcname is
+ * the file in the source tree, and destname is the corresponding file
+ * in the destination tree. The return value is false if the file
+ * could not be processed.
+ */
+typedef int (*watchhandler)(char const *srcname, char const *destname,
+                            void *data);
+
+/* Processes every file under srcdir, and then continues to process
+ * files as they are modified, until a signal to terminate is
+ * received. Files and directories that are deleted from srcdir are
+ * also deleted from destdir. The return value is false if the
+ * directories could not be set up for watching.
+ */
+extern int runwatch(char const *srcdir, char const *destdir,
+                    watchhandler handler, void *data);
+
+#endif